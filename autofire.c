@@ -0,0 +1,113 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+
+#include "autofire.h"
+#include "config.h"
+
+// Autofire toggles the reported button of a port while it is held. The
+// toggles are done by alarm callbacks, so they are not quantised to the main
+// loop. Both phases are rounded to multiples of the HID polling interval, so
+// each phase spans the same number of host polls, and the first alarm is
+// started on a SOF to align the phases with the frame clock. Each toggle
+// wakes the main loop, so the report goes out right away instead of up to a
+// loop period later. Without autofire enabled no SOF callbacks and no alarms
+// are running.
+
+typedef struct {
+  uint32_t on_us;  // 0 = autofire disabled
+  uint32_t off_us;
+  alarm_id_t alarm;
+  bool held;
+} port_autofire;
+
+static port_autofire ports[PORT_NUM];
+static uint8_t pending = 0; // ports waiting for the next SOF
+
+volatile bool autofire_off[PORT_NUM];
+volatile bool autofire_toggled;
+
+static uint32_t quantize(const uint32_t us) {
+  const uint32_t interval = usb_poll_interval_ms() * 1000;
+  const uint32_t n = (us + interval / 2) / interval;
+  return (n ? n : 1) * interval;
+}
+
+void autofire_setup(void) {
+  pending = 0;
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    port_autofire *a = &ports[p];
+    if (a->alarm > 0) cancel_alarm(a->alarm);
+    a->alarm = 0;
+    a->held = false;
+    autofire_off[p] = false;
+
+    if (config.autofire_hz[p]) {
+      const uint32_t period = 1000000 / config.autofire_hz[p];
+      a->on_us = quantize(period * config.autofire_duty[p] / 100);
+      a->off_us = quantize(period - period * config.autofire_duty[p] / 100);
+    } else {
+      a->on_us = 0;
+    }
+  }
+}
+
+static int64_t toggle(alarm_id_t id, void *user_data) {
+  const uint8_t p = (uintptr_t)user_data;
+  autofire_off[p] = !autofire_off[p];
+  autofire_toggled = true;
+  __sev();
+  // reschedule relative to this alarm's target time, so the phases don't drift
+  return autofire_off[p] ? ports[p].off_us : ports[p].on_us;
+}
+
+void autofire_button(const uint8_t p, const bool pressed) {
+  port_autofire *a = &ports[p];
+  if (!a->on_us || a->held == pressed) return;
+  a->held = pressed;
+
+  if (pressed) {
+    // the first on phase starts right away and ends aligned to a SOF
+    pending |= 1 << p;
+    tud_sof_cb_enable(true);
+  } else {
+    pending &= ~(1 << p);
+    if (a->alarm > 0) cancel_alarm(a->alarm);
+    a->alarm = 0;
+    autofire_off[p] = false;
+  }
+}
+
+void autofire_sof(void) {
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (pending & (1 << p)) {
+      ports[p].alarm = add_alarm_in_us(ports[p].on_us, toggle, (void *)(uintptr_t)p, true);
+    }
+  }
+  pending = 0;
+  tud_sof_cb_enable(false);
+}
@@ -0,0 +1,50 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef AUTOFIRE_H_
+#define AUTOFIRE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dualjoy.h"
+
+// true while the held button of a port is in the released phase of autofire,
+// toggled from the alarm callbacks
+extern volatile bool autofire_off[PORT_NUM];
+// set by the alarm callbacks along with an event (__sev()), the main loop
+// clears it when it sent the toggled state
+extern volatile bool autofire_toggled;
+
+// compute the on/off phases of all ports from the config, stops running
+// autofire until the next autofire_button() call
+void autofire_setup(void);
+
+// to be called when the (debounced) button of a port changes
+void autofire_button(uint8_t port, bool pressed);
+
+// to be called from tud_sof_cb(), starts the pending autofire alarms
+void autofire_sof(void);
+
+#endif /* AUTOFIRE_H_ */
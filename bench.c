@@ -0,0 +1,203 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Cycle benchmark of the input pipeline and the report builders on the
+// target, without USB: feeds a fixed bouncy waveform through input.c and
+// reports.c for every debounce engine and USB mode, counts the cycles with
+// the profiling counters and prints the results over the UART. trace() is
+// compiled out, so only the table uses the UART. The timing
+// is virtual, so it runs the same on a Pico and in an instruction set
+// emulator of the RP2040 or RP2350.
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+#include "config.h"
+#include "input.h"
+#include "reports.h"
+#include "mouse.h"
+#include "oversample.h"
+#include "profile.h"
+#include "protocol.h"
+
+#if !DUALJOY_PROFILE
+#error "the benchmark counts with the profiling counters, build it with DUALJOY_PROFILE=1"
+#endif
+
+enum {
+  BENCH_SAMPLES = 10000,
+  BENCH_LOOP_US = 1000,   // virtual time between two samples
+  BENCH_TOGGLE_RATE = 8,  // a pin toggles in every 8th sample on average
+};
+
+dj_counters counters;
+
+static uint32_t waveform[BENCH_SAMPLES];
+static uint32_t queued;
+
+//--------------------------------------------------------------------+
+// Platform hooks
+//--------------------------------------------------------------------+
+
+bool report_transmit(const uint8_t instance, const uint8_t report_id, const void *report, const uint16_t len) {
+  (void) instance;
+  (void) report_id;
+  (void) report;
+  (void) len;
+  return true;
+}
+
+bool report_ready(const uint8_t instance) {
+  (void) instance;
+  return true;
+}
+
+void report_queued(const uint8_t ports) {
+  (void) ports;
+  queued++;
+}
+
+void report_unchanged(const uint8_t ports) {
+  (void) ports;
+}
+
+void report_failed(void) {
+}
+
+// the motion is integrated in a timer callback, not in the main loop
+void mouse_direction(const uint8_t pins) {
+  (void) pins;
+}
+
+bool mouse_take(int8_t *dx, int8_t *dy) {
+  *dx = *dy = 0;
+  return false;
+}
+
+//--------------------------------------------------------------------+
+// Benchmark
+//--------------------------------------------------------------------+
+
+// toggles random pins, most toggles fall into the lockout of the previous
+// edge of their pin like bounces do, the others are edges
+static void setup_waveform(void) {
+  uint32_t rng = 1;
+  uint32_t pins = 0;
+
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    // xorshift32
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    if (rng % BENCH_TOGGLE_RATE == 0) pins ^= 1u << config.gpios[(rng >> 8) % TOTAL_PIN_NUM];
+    waveform[i] = pins & input_pin_mask();
+  }
+}
+
+// Runs the waveform through the pipeline like update_states_task() and
+// send_states() do. DJ_PROFILE_UPDATE_STATES gets the cycles per sample,
+// DJ_PROFILE_SEND_STATES the cycles of the calls that queued reports.
+// In the oversampling mode the samples also go through the majority vote,
+// like in sample_pins(). Instead of the DMA ring it runs on a ring that gets
+// one waveform sample per loop; the vote takes the same cycles for any
+// content.
+static void bench(const uint8_t debounce_mode, const uint8_t usb_mode) {
+  static report ports[PORT_NUM];
+  static uint32_t ring[OVERSAMPLE_RING_SIZE];
+
+  config.debounce_mode = debounce_mode;
+  config.usb_mode = usb_mode;
+  input_setup_debounce();
+  input_preset(0);
+  for (uint8_t p = 0; p < PORT_NUM; p++) ports[p] = input_decode(p);
+  input_decode_changed(ports);
+  reports_select(usb_mode);
+  reports_resend();
+  profile_init();
+  queued = 0;
+  for (uint32_t i = 0; i < OVERSAMPLE_RING_SIZE; i++) ring[i] = ~0u;
+
+  const uint32_t irq = save_and_disable_interrupts();
+  uint32_t now = 0;
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    now += BENCH_LOOP_US;
+    ring[i % OVERSAMPLE_RING_SIZE] = ~waveform[i]; // the GPIOs are low when pressed
+
+    PROFILE_BEGIN(DJ_PROFILE_UPDATE_STATES);
+    uint32_t pins = waveform[i];
+    if (debounce_mode == DEBOUNCE_OVERSAMPLE) {
+      pins = oversample_vote(ring, i + 1, config.vote_m, config.vote_n) & input_pin_mask();
+    }
+    input_update(pins, now);
+    input_decode_changed(ports);
+    PROFILE_END(DJ_PROFILE_UPDATE_STATES);
+
+    const uint32_t before = queued;
+    const uint32_t start = profile_cycles();
+    reports_send(ports);
+    const uint32_t cycles = profile_elapsed(start);
+    if (queued != before) profile_record(DJ_PROFILE_SEND_STATES, cycles);
+  }
+  restore_interrupts(irq);
+}
+
+static void print_slot(const dj_profile_slot *s) {
+  const uint64_t total = ((uint64_t)s->total_hi << 32) | s->total_lo;
+  if (!s->count) {
+    printf(" %8s %6s %6s", "-", "-", "-");
+    return;
+  }
+  printf(" %8u %6u %6u", (unsigned)(total / s->count), (unsigned)s->min, (unsigned)s->max);
+}
+
+int main(void) {
+  static const char *const debounce_names[] = { "fixed", "adaptive", "oversample" };
+  static const char *const mode_names[USB_MODE_NUM] = { "gamepad", "keyboard", "xinput", "mouse", "combined" };
+
+  stdio_init_all();
+  config_set_defaults(&config);
+  input_setup_pins();
+  input_setup_decoders();
+  setup_waveform();
+
+  printf("dualjoy_bench, %u samples, %u MHz\n", BENCH_SAMPLES, (unsigned)(clock_get_hz(clk_sys) / 1000000));
+  printf("cycles per sample, and per reports_send() that queued reports: avg min max\n");
+  printf("%-10s %-8s %8s %6s %6s %8s %6s %6s %7s\n", "debounce", "mode", "sample", "min", "max",
+         "send", "min", "max", "reports");
+  for (uint8_t d = DEBOUNCE_FIXED; d <= DEBOUNCE_OVERSAMPLE; d++) {
+    for (uint8_t m = 0; m < USB_MODE_NUM; m++) {
+      bench(d, m);
+      printf("%-10s %-8s", debounce_names[d], mode_names[m]);
+      print_slot(&profile.slots[DJ_PROFILE_UPDATE_STATES]);
+      print_slot(&profile.slots[DJ_PROFILE_SEND_STATES]);
+      printf(" %7u\n", (unsigned)queued);
+    }
+  }
+  printf("done\n");
+
+  while (true) __wfi();
+}
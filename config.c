@@ -0,0 +1,214 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "tusb.h"
+
+#include "config.h"
+#include "oversample.h"
+
+//DB9-connector:
+//C64/Sega Mastersystem: 1 = up, 2 = down, 3 = left, 4 = right, 6 = btn1, 8 = gnd, 9 = btn2
+//MSX: 1 = up, 2 = down, 3 = left, 4 = right, 6 = btn1, 7 = btn2, 8 = gnd
+
+// Default wiring, used if the flash doesn't contain a valid config.
+
+// for prototype
+// enum gpio {
+//   J1_UP = 5,
+//   J1_DOWN = 4,
+//   J1_LEFT = 3,
+//   J1_RIGHT = 2,
+//   J1_BTN = 27,
+
+//   J2_UP = 9,
+//   J2_DOWN = 8,
+//   J2_LEFT = 7,
+//   J2_RIGHT = 6,
+//   J2_BTN = 26,
+// };
+
+// for production
+enum gpio {
+  J1_UP = 10,
+  J1_DOWN = 11,
+  J1_LEFT = 12,
+  J1_RIGHT = 13,
+  J1_BTN = 9,
+
+  J2_UP = 18,
+  J2_DOWN = 19,
+  J2_LEFT = 20,
+  J2_RIGHT = 21,
+  J2_BTN = 17,
+};
+
+// the config lives in the last sector of the flash
+#define CONFIG_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define CONFIG_MAGIC 0x594a4c44 // "DLJY"
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  dualjoy_config data;
+  uint32_t checksum;
+} stored_config;
+
+#define STORED_CONFIG_PAGES ((sizeof(stored_config) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE)
+
+dualjoy_config config;
+
+static uint32_t checksum(const dualjoy_config *cfg) {
+  // FNV-1a
+  const uint8_t *p = (const uint8_t *)cfg;
+  uint32_t h = 0x811c9dc5;
+  for (size_t i = 0; i < sizeof(*cfg); i++) {
+    h ^= p[i];
+    h *= 0x01000193;
+  }
+  return h;
+}
+
+void config_set_defaults(dualjoy_config *cfg) {
+  static const uint8_t default_gpios[TOTAL_PIN_NUM] = {
+    J1_UP, J1_DOWN, J1_LEFT, J1_RIGHT, J1_BTN,
+    J2_UP, J2_DOWN, J2_LEFT, J2_RIGHT, J2_BTN
+  };
+  // J1: cursor keys and right ctrl, J2: WSAD and left ctrl
+  static const uint8_t default_keys[TOTAL_PIN_NUM] = {
+    HID_KEY_ARROW_UP, HID_KEY_ARROW_DOWN, HID_KEY_ARROW_LEFT, HID_KEY_ARROW_RIGHT, HID_KEY_CONTROL_RIGHT,
+    HID_KEY_W, HID_KEY_S, HID_KEY_A, HID_KEY_D, HID_KEY_CONTROL_LEFT
+  };
+
+  memset(cfg, 0, sizeof(*cfg));
+  memcpy(cfg->gpios, default_gpios, sizeof(cfg->gpios));
+  cfg->debounce_mode = DEBOUNCE_FIXED;
+  cfg->debounce_us = DEBOUNCE_TIMEOUT_US;
+  cfg->oversample_khz = 100;
+  cfg->vote_m = 15;
+  cfg->vote_n = 8;
+  cfg->poll_interval_ms = HID_POLL_INTERVAL_MS;
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    cfg->autofire_duty[p] = 50;
+  }
+  memcpy(cfg->keys, default_keys, sizeof(cfg->keys));
+  cfg->mouse_speed = 800;
+  cfg->mouse_accel_ms = 500;
+}
+
+bool config_valid(const dualjoy_config *cfg) {
+  uint32_t used = 0;
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    const uint8_t gpio = cfg->gpios[i];
+    // pin masks are 32 bit wide
+    if (gpio >= NUM_BANK0_GPIOS || gpio >= 32) return false;
+    if (used & (1u << gpio)) return false;
+#ifdef PICO_DEFAULT_LED_PIN
+    if (gpio == PICO_DEFAULT_LED_PIN) return false;
+#endif
+#if PICO_RP2040_USB_DEVICE_ENUMERATION_FIX
+    if (gpio == 15) return false; // used by the errata RP2040-E5 fix
+#endif
+    used |= 1u << gpio;
+
+    const uint16_t learned = cfg->learned_debounce_us[i];
+    if (learned && (learned < DEBOUNCE_MIN_US || learned > DEBOUNCE_MAX_US)) return false;
+  }
+  // before the autofire rates, which are checked against it
+  if (cfg->poll_interval_ms < 1 || cfg->poll_interval_ms > 32) return false;
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (cfg->port_protocol[p] >= PORT_PROTOCOL_NUM) return false;
+    if (cfg->dir_mode[p] >= DIR_MODE_NUM || cfg->socd_mode[p] >= SOCD_MODE_NUM) return false;
+    // both phases need to last at least one HID polling interval
+    if (cfg->autofire_hz[p] > 1000 / (2 * cfg->poll_interval_ms)) return false;
+    if (cfg->autofire_duty[p] < 1 || cfg->autofire_duty[p] > 99) return false;
+  }
+  if (cfg->debounce_mode > DEBOUNCE_OVERSAMPLE) return false;
+  if (cfg->oversample_khz < 10 || cfg->oversample_khz > 200) return false;
+  if (cfg->vote_n == 0 || cfg->vote_n > cfg->vote_m || cfg->vote_m > OVERSAMPLE_MAX_WINDOW) return false;
+  if (cfg->debounce_us > DEBOUNCE_MAX_US) return false;
+  if (cfg->clock_governor > 1) return false;
+  if (cfg->usb_mode >= USB_MODE_NUM) return false;
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    const uint8_t key = cfg->keys[i];
+    if (key >= KEYBOARD_KEY_NUM && (key < KEYBOARD_MODIFIER_FIRST || key > KEYBOARD_MODIFIER_LAST)) return false;
+  }
+  if (cfg->mouse_port >= PORT_NUM) return false;
+  if (cfg->mouse_speed < MOUSE_SPEED_MIN || cfg->mouse_speed > MOUSE_SPEED_MAX) return false;
+  if (cfg->mouse_accel_ms > MOUSE_ACCEL_MAX_MS) return false;
+  return true;
+}
+
+static inline const stored_config *stored_sector(void) {
+  const stored_config *stored = (const stored_config *)(XIP_BASE + CONFIG_FLASH_OFFSET);
+
+  if (stored->magic == CONFIG_MAGIC &&
+      stored->version == CONFIG_VERSION &&
+      stored->checksum == checksum(&stored->data) &&
+      config_valid(&stored->data)) {
+    return stored;
+  }
+  return NULL;
+}
+
+bool config_load(void) {
+  const stored_config *stored = stored_sector();
+
+  if (stored) {
+    memcpy(&config, &stored->data, sizeof(config));
+    return true;
+  }
+
+  config_set_defaults(&config);
+  return false;
+}
+
+static void __no_inline_not_in_flash_func(write_config_sector)(void *data) {
+  flash_range_erase(CONFIG_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+  flash_range_program(CONFIG_FLASH_OFFSET, data, STORED_CONFIG_PAGES * FLASH_PAGE_SIZE);
+}
+
+bool config_save(void) {
+  static union {
+    stored_config stored;
+    uint8_t pages[STORED_CONFIG_PAGES * FLASH_PAGE_SIZE];
+  } buf;
+
+  // the host decides how often SAVE is sent, don't wear the flash or stall
+  // the sampling for a config that is already stored
+  const stored_config *stored = stored_sector();
+  if (stored && memcmp(&stored->data, &config, sizeof(config)) == 0) return true;
+
+  memset(&buf, 0xff, sizeof(buf));
+  buf.stored.magic = CONFIG_MAGIC;
+  buf.stored.version = CONFIG_VERSION;
+  memcpy(&buf.stored.data, &config, sizeof(config));
+  buf.stored.checksum = checksum(&config);
+
+  return flash_safe_execute(write_config_sector, buf.pages, UINT32_MAX) == PICO_OK;
+}
@@ -0,0 +1,72 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dualjoy.h"
+
+// bump whenever the layout of dualjoy_config changes, stored configs with a
+// different version are ignored and the defaults are used instead
+#define CONFIG_VERSION 9
+
+typedef struct {
+  uint8_t gpios[TOTAL_PIN_NUM]; // GPIO of each pin, indexed by port * PIN_NUM + enum pin
+  uint8_t debounce_mode;        // enum debounce_mode
+  uint16_t debounce_us;         // lockout window in DEBOUNCE_FIXED mode
+  uint16_t learned_debounce_us[TOTAL_PIN_NUM]; // per pin window learned in DEBOUNCE_ADAPTIVE mode, 0 = not learned yet
+  uint8_t oversample_khz;       // sample rate in DEBOUNCE_OVERSAMPLE mode
+  uint8_t vote_m;               // a pin is active if it was low in vote_n
+  uint8_t vote_n;               // of the last vote_m samples
+  uint8_t poll_interval_ms;     // HID endpoint polling interval
+  uint8_t port_protocol[PORT_NUM]; // enum port_protocol
+  uint8_t dir_mode[PORT_NUM];   // enum dir_mode
+  uint8_t socd_mode[PORT_NUM];  // enum socd_mode
+  uint8_t autofire_hz[PORT_NUM];    // autofire rate of the button, 0 = off
+  uint8_t autofire_duty[PORT_NUM];  // percentage of the period the button is reported pressed
+  uint8_t clock_governor;       // 1 = lower clk_sys while there is little to do
+  uint8_t usb_mode;             // enum usb_mode
+  uint8_t keys[TOTAL_PIN_NUM];  // HID key usage of each pin in USB_MODE_KEYBOARD, 0 = none
+  uint8_t mouse_port;           // port moving the mouse in USB_MODE_MOUSE
+  uint16_t mouse_speed;         // full speed in pixels per second
+  uint16_t mouse_accel_ms;      // time from the start speed to full speed
+} dualjoy_config;
+
+extern dualjoy_config config;
+
+// load the config from flash, falls back to the defaults if there is no valid
+// config stored. Returns true if a stored config was loaded.
+bool config_load(void);
+
+// write the current config to flash. Stalls the CPU for the duration of the
+// sector erase, so only call this outside of latency critical phases.
+bool config_save(void);
+
+void config_set_defaults(dualjoy_config *cfg);
+bool config_valid(const dualjoy_config *cfg);
+
+#endif /* CONFIG_H_ */
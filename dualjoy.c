@@ -34,286 +34,292 @@
 #include "tusb.h"
 
 #include "dualjoy.h"
+#include "config.h"
+#include "oversample.h"
+#include "autofire.h"
+#include "protocol.h"
+#include "profile.h"
+#include "led.h"
+#include "governor.h"
+#include "xinput.h"
+#include "mouse.h"
+#include "input.h"
+#include "reports.h"
 
 //--------------------------------------------------------------------+
 // MACRO CONSTANT TYPEDEF PROTYPES
 //--------------------------------------------------------------------+
 
-/* Blink pattern
- * - 250 ms  : device not mounted
- * - 1000 ms : device mounted
- * - 2500 ms : device is suspended
- */
 enum {
-  BLINK_OFF = 0,
-  BLINK_NOT_MOUNTED = 250 * 1000,
-  BLINK_SUSPENDED = 2500 * 1000,
-  DEBOUNCE_TIMEOUT_US = 20 * 1000,
-  EVENT_FLASH_US = 30 * 1000,
-  BLINK_FAST_US = 50 * 1000,
-  MAX_DELAY_US = BLINK_SUSPENDED, // must be set to the largest wait interval
+  DEBOUNCE_SAVE_DELTA_US = 1000, // persist learned windows if one drifted this far
 };
 
 #define ARRAY_SIZE(_arr) ( sizeof(_arr) / sizeof(_arr[0]) )
 
-static uint32_t blink_interval_us = BLINK_NOT_MOUNTED;
-static uint32_t blink_timeout_us = 0;
-static bool led_state = false;
-
 
 // ----------------------------- JOYSTICK BEGIN ----------------------------
 
-//DB9-connector:
-//C64/Sega Mastersystem: 1 = up, 2 = down, 3 = left, 4 = right, 6 = btn1, 8 = gnd, 9 = btn2
-//MSX: 1 = up, 2 = down, 3 = left, 4 = right, 6 = btn1, 7 = btn2, 8 = gnd
-
-// for prototype
-// enum gpio {
-//   J1_UP = 5,
-//   J1_DOWN = 4,
-//   J1_LEFT = 3,
-//   J1_RIGHT = 2,
-//   J1_BTN = 27,
-
-//   J2_UP = 9,
-//   J2_DOWN = 8,
-//   J2_LEFT = 7,
-//   J2_RIGHT = 6,
-//   J2_BTN = 26,
-// };
-
-// for production
-enum gpio {
-  J1_UP = 10,
-  J1_DOWN = 11,
-  J1_LEFT = 12,
-  J1_RIGHT = 13,
-  J1_BTN = 9,
-
-  J2_UP = 18,
-  J2_DOWN = 19,
-  J2_LEFT = 20,
-  J2_RIGHT = 21,
-  J2_BTN = 17,
-};
-
-
-#define J1_MASK (1<<J1_UP | 1<<J1_DOWN | 1<<J1_LEFT | 1<<J1_RIGHT | 1<<J1_BTN)
-#define J2_MASK (1<<J2_UP | 1<<J2_DOWN | 1<<J2_LEFT | 1<<J2_RIGHT | 1<<J2_BTN)
+static bool persist_pending = false;  // check if the config needs to be written
+static bool save_requested = false;
+
+dj_counters counters;
+dj_histograms histograms;
+dj_boot boot;
+dj_trace input_trace;
+static uint32_t port_edge_us[PORT_NUM]; // first edge not yet covered by a queued report
+static uint8_t port_edge_pending = 0;
+static uint32_t inflight_edge_us[PORT_NUM]; // first edge covered by the report in flight
+static uint8_t inflight_pending = 0;
+
+static inline void histogram_add(uint32_t *buckets, const uint32_t latency) {
+  const uint8_t b = 31 - __builtin_clz(latency | 1);
+  buckets[b < DJ_HIST_BUCKETS ? b : DJ_HIST_BUCKETS - 1]++;
+}
 
-#define PIN_MASK (J1_MASK | J2_MASK)
+static report decoded[PORT_NUM];
+static report last_r[PORT_NUM]; // current state of each port, after autofire
 
-enum pin {
-  UP = 0,
-  DOWN,
-  LEFT,
-  RIGHT,
-  BTN,
-  PIN_NUM,
-  TOTAL_PIN_NUM = PIN_NUM * 2,
-};
+//--------------------------------------------------------------------+
+// Report hooks, see reports.h
+//--------------------------------------------------------------------+
 
-static const uint8_t inputGPIOs[TOTAL_PIN_NUM] = {
-  J1_UP, J1_DOWN, J1_LEFT, J1_RIGHT, J1_BTN,
-  J2_UP, J2_DOWN, J2_LEFT, J2_RIGHT, J2_BTN
-};
+bool report_transmit(const uint8_t instance, const uint8_t report_id, const void *report, const uint16_t len) {
+  if (!report_id) return xinput_report_send(instance, report);
+  return tud_hid_n_report(instance, report_id, report, len);
+}
 
-static const uint32_t inputMasks[TOTAL_PIN_NUM] = {
-  1 << J1_UP, 1 << J1_DOWN, 1 << J1_LEFT, 1 << J1_RIGHT, 1 << J1_BTN,
-  1 << J2_UP, 1 << J2_DOWN, 1 << J2_LEFT, 1 << J2_RIGHT, 1 << J2_BTN
-};
+// set by select_reports(), so asking for a free endpoint doesn't branch on
+// the mode for every report
+static bool (*instance_ready)(uint8_t instance) = tud_hid_n_ready;
 
-static const uint8_t gpio2pin[32] = {
-  [J1_UP] = UP,
-  [J1_DOWN] = DOWN,
-  [J1_LEFT] = LEFT,
-  [J1_RIGHT] = RIGHT,
-  [J1_BTN] = BTN,
-  [J2_UP] = PIN_NUM+UP,
-  [J2_DOWN] = PIN_NUM+DOWN,
-  [J2_LEFT] = PIN_NUM+LEFT,
-  [J2_RIGHT] = PIN_NUM+RIGHT,
-  [J2_BTN] = PIN_NUM+BTN,
-};
+bool report_ready(const uint8_t instance) {
+  return instance_ready(instance);
+}
 
-static uint32_t pin_states = 0;
-static uint32_t pin_timeouts[TOTAL_PIN_NUM] = { 0 };
-
-static inline uint8_t states2direction(const uint32_t mask[PIN_NUM]) {
-  if (pin_states & mask[UP]) {
-    if (pin_states & mask[RIGHT])
-      return 1;  // NE
-    else if (pin_states & mask[LEFT])
-      return 7;  // NW
-    else
-      return 0;  // N
+// bookkeeping after a report covering ports was queued
+void report_queued(const uint8_t ports) {
+  const uint32_t now = time_us_32();
+
+  led_show(LED_FLASH);
+  if (!boot.done_us[DJ_BOOT_FIRST_REPORT]) boot.done_us[DJ_BOOT_FIRST_REPORT] = now;
+  counters.reports++;
+  inflight_pending &= ~ports;
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (ports & port_edge_pending & (1 << p)) {
+      const uint32_t latency = now - port_edge_us[p];
+      if (latency > counters.edge_latency_max_us) counters.edge_latency_max_us = latency;
+      histogram_add(histograms.queued[p], latency);
+      inflight_edge_us[p] = port_edge_us[p];
+      inflight_pending |= 1 << p;
+    }
   }
-  else if (pin_states & mask[DOWN]) {
-    if (pin_states & mask[RIGHT])
-      return 3;  // SE
-    else if (pin_states & mask[LEFT])
-      return 5;  // SW
-    else
-      return 4;  // S
+  port_edge_pending &= ~ports;
+}
+
+// bookkeeping after the host picked up a report covering ports
+static inline void report_completed(const uint8_t ports) {
+  const uint8_t done = ports & inflight_pending;
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (done & (1 << p)) histogram_add(histograms.completed[p], time_us_32() - inflight_edge_us[p]);
   }
-  else if (pin_states & mask[RIGHT])
-    return 2;  // E
-  else if (pin_states & mask[LEFT])
-    return 6;  // W
-  else
-    return 8;  // Center (null state, outside logical range 0-7)
+  inflight_pending &= ~done;
 }
 
-static inline bool reached(const uint32_t t) {
-  // overflow safe time comparison
-  return t == 0 || t-time_us_32() > MAX_DELAY_US;
+void report_unchanged(const uint8_t ports) {
+  port_edge_pending &= ~ports; // the edges didn't change the report
 }
 
-static inline uint32_t time_after_us(uint32_t us) {
-  if (us > MAX_DELAY_US) us = MAX_DELAY_US;
-  return (time_us_32() + us) | 1; // make sure it's never 0 after overflow
+void report_failed(void) {
+  trace("###################################### failed to send report\n");
+  counters.report_failures++;
 }
 
-static inline void led_flash() {
-  led_state = !led_state;
-  board_led_write(led_state);
-  blink_interval_us = BLINK_OFF;
-  blink_timeout_us = time_after_us(EVENT_FLASH_US);
+// a sample is recorded if it differs from the debounced state or from the
+// previous sample, all other samples don't change anything in the pipeline
+static inline void record_sample(const uint32_t now, const uint32_t pins) {
+  static uint32_t last_pins = 0;
+  const uint32_t states = input_states();
+
+  if (input_trace.frozen || (pins == states && pins == last_pins)) return;
+  last_pins = pins;
+  dj_trace_entry *e = &input_trace.entries[input_trace.count % DJ_TRACE_LEN];
+  e->time_us = now;
+  e->pins = pins;
+  e->states = states;
+  input_trace.count++;
 }
 
-static inline void led_set_blink_mode(const uint32_t interval) {
-  blink_timeout_us = 0;
-  if (interval == BLINK_OFF) {
-    led_state = false;
-    board_led_write(false);
+// restarts the recording with the current windows, a replay starts from them
+static inline void reset_trace() {
+  input_trace.count = 0;
+  input_trace.frozen = false;
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    input_trace.windows_us[i] = input_debounce_window(i);
+    input_trace.gpios[i] = input_gpio(i);
   }
-  blink_interval_us = interval;
 }
 
-static inline void led_blink_fast_until(const uint32_t timeout) {
-  blink_timeout_us = timeout;
-  blink_interval_us = BLINK_FAST_US;
+static inline void setup_reports() {
+  // start with the idle state, so GET_REPORT has a valid answer right away
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    decoded[p] = input_decode(p);
+    REPORT_COPY(last_r[p], decoded[p]);
+  }
 }
 
+static void select_reports(const uint8_t mode) {
+  reports_select(mode);
+  instance_ready = mode == USB_MODE_XINPUT ? xinput_ready : tud_hid_n_ready;
+  mouse_setup(mode == USB_MODE_MOUSE);
+}
 
-typedef struct {
-  uint8_t direction;
-  uint8_t buttons;
-} report;
+static inline void send_states() {
+  const uint8_t changed = input_decode_changed(decoded);
 
-#define REPORT_EQUAL(a, b) (a.direction == b.direction && a.buttons == b.buttons)
-#define REPORT_COPY(a, b) do { a.direction = b.direction; a.buttons = b.buttons; } while (0)
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (changed & (1 << p)) autofire_button(p, decoded[p].buttons);
+    REPORT_COPY(last_r[p], decoded[p]);
+    if (autofire_off[p]) last_r[p].buttons = 0;
+  }
 
-static inline void send_states() {
-  static report last_r1 = {0, 0};
-  static report last_r2 = {0, 0};
-  static report sent_r1 = {0, 0};
-  static report sent_r2 = {0, 0};
-  static uint32_t last_states = 0;
-
-  const uint32_t changes = last_states ^ pin_states;
-
-  if (changes) {
-    if (changes & J1_MASK) {
-      last_r1.direction = states2direction(&inputMasks[0]);
-      last_r1.buttons = (pin_states & inputMasks[BTN]) ? 1 : 0;
-    }
-    if (changes & J2_MASK) {
-      last_r2.direction = states2direction(&inputMasks[PIN_NUM]);
-      last_r2.buttons = (pin_states & inputMasks[PIN_NUM+BTN]) ? 1 : 0;
-    }
-    last_states = pin_states;
+  if (!tud_mounted()) {
+    port_edge_pending = 0; // don't count the enumeration as latency
+    return; // the held state is sent right after the mount
   }
 
-  if (!REPORT_EQUAL(sent_r1, last_r1)) {
-    trace("XXXXXXXXXXXXXXXXXXXXXXXXXXXXXX J1: %d %x\n", last_r1.direction, last_r1.buttons);
-    if (tud_hid_n_report(0, JOYSTICK_REPORT_ID, &last_r1, sizeof(report))) {
-      led_flash();
-      REPORT_COPY(sent_r1, last_r1);
-    } else {
-      trace("###################################### failed to send report\n");
+  reports_send(last_r);
+}
+
+// Writes the config to flash if requested or if a learned debounce window
+// drifted away from the stored one. Waits until the sticks have been idle for
+// a while, since the flash write stalls the sampling.
+static inline void persist_task() {
+  if (!persist_pending || !input_idle(time_us_32())) return;
+  persist_pending = false;
+
+  bool dirty = save_requested;
+  save_requested = false;
+  if (config.debounce_mode == DEBOUNCE_ADAPTIVE) {
+    for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+      const int32_t delta = (int32_t)input_debounce_window(i) - config.learned_debounce_us[i];
+      if (delta > DEBOUNCE_SAVE_DELTA_US || delta < -DEBOUNCE_SAVE_DELTA_US) dirty = true;
     }
   }
+  if (!dirty) return;
 
-  if (!REPORT_EQUAL(sent_r2, last_r2)) {
-    trace("XXXXXXXXXXXXXXXXXXXXXXXXXXXXXX J2: %d %x\n", last_r2.direction, last_r2.buttons);
-    if (tud_hid_n_report(1, JOYSTICK2_REPORT_ID, &last_r2, sizeof(report))) {
-      led_flash();
-      REPORT_COPY(sent_r2, last_r2);
-    } else {
-      trace("###################################### failed to send report\n");
+  if (config.debounce_mode == DEBOUNCE_ADAPTIVE) {
+    for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+      config.learned_debounce_us[i] = input_debounce_window(i);
     }
   }
+  trace("%s saving config\n", __func__);
+  if (!config_save()) led_show(LED_ERROR_SAVE);
 }
 
-static inline uint8_t fast_log2_of_pow2(const uint32_t x) {
-    static const uint32_t deBruijnSequence = 0x077CB531U;
-    static const uint8_t lookupTable[32] = {
-        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
-        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
-    };
-    // Multiply by de Bruijn sequence
-    return lookupTable[((x * deBruijnSequence) >> 27)];
+static inline uint32_t sample_pins() {
+  if (config.debounce_mode == DEBOUNCE_OVERSAMPLE)
+    return oversample_read(config.vote_m, config.vote_n) & input_pin_mask();
+  return (~gpio_get_all()) & input_pin_mask();
 }
 
 static inline void update_states_task() {
-  const uint32_t pins = (~gpio_get_all()) & PIN_MASK;
-  uint32_t changes = pins ^ pin_states;
-
-  // beware, here comes some serious over-engineering
-  while (changes) {
-    trace("%s pins: %.32b pin_states: %.32b changes: %.32b\n", __func__, pins, pin_states, changes);
-    const uint32_t mask = changes & -changes; // isolate least significant changed bit
-    changes &= ~mask; // remove that bit from changes
-    const uint8_t i = fast_log2_of_pow2(mask); // calculate bit position
-    if (reached(pin_timeouts[gpio2pin[i]])) {
-      trace("%s changing pin_state %d to %d\n", __func__, i, !(pin_states & mask));
-      pin_states ^= mask;
-      pin_timeouts[gpio2pin[i]] = time_after_us(DEBOUNCE_TIMEOUT_US);
-    } else {
-        trace("%s skipping pin_state %d because recent change\n", __func__, i);
+  const uint32_t pins = sample_pins();
+  const uint32_t now = time_us_32();
+
+  record_sample(now, pins);
+  const uint8_t edge_ports = input_update(pins, now);
+  if (edge_ports) {
+    for (uint8_t p = 0; p < PORT_NUM; p++) {
+      if ((edge_ports & (1 << p)) && !(port_edge_pending & (1 << p))) port_edge_us[p] = now;
     }
+    port_edge_pending |= edge_ports;
+    // the learned windows may have moved
+    if (config.debounce_mode == DEBOUNCE_ADAPTIVE) persist_pending = true;
   }
 
+  PROFILE_BEGIN(DJ_PROFILE_SEND_STATES);
   send_states();
+  PROFILE_END(DJ_PROFILE_SEND_STATES);
 }
 
+enum {
+  PULLUP_SETTLE_US = 100, // until the pull-ups charged the cable, generous
+};
+
 static inline void setup_gpios() {
   //set all DB9-connector input signal pins as inputs with pullups
-  for (uint8_t i = 0; i < sizeof(inputGPIOs); i++) {
-    gpio_init(inputGPIOs[i]);
-    gpio_set_dir(inputGPIOs[i], GPIO_IN);
-    gpio_pull_up(inputGPIOs[i]);
-    gpio_set_drive_strength(inputGPIOs[i], GPIO_DRIVE_STRENGTH_2MA);
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    gpio_init(config.gpios[i]);
+    gpio_set_dir(config.gpios[i], GPIO_IN);
+    gpio_pull_up(config.gpios[i]);
+    gpio_set_drive_strength(config.gpios[i], GPIO_DRIVE_STRENGTH_2MA);
   }
+  // otherwise released pins would be seen pressed by the first samples
+  busy_wait_us(PULLUP_SETTLE_US);
 }
 
 // ------------------------------JOYSTICK END ------------------------------
 
 
+// Sleeps for about a loop period. An autofire toggle ends the wait early, so
+// the report with the new phase is queued right after the SOF aligned alarm.
+static inline void loop_wait(void) {
+  const absolute_time_t until = make_timeout_time_ms(1);
+  while (!autofire_toggled && !best_effort_wfe_or_timeout(until)) {
+    tight_loop_contents();
+  }
+  autofire_toggled = false;
+}
+
+static inline void count_loop(const uint32_t start) {
+  const uint32_t t = time_us_32() - start;
+  counters.loops++;
+  counters.loop_time_us += t;
+  if (t > counters.loop_time_max_us) counters.loop_time_max_us = t;
+}
+
 //--------------------------------------------------------------------+
-// BLINKING TASK
+// CONFIG PROTOCOL HOOKS
 //--------------------------------------------------------------------+
-static inline void led_blinking_task()
-{
-  static uint32_t next_us = 0;
 
-  if (blink_timeout_us && reached(blink_timeout_us)) {
-    led_set_blink_mode(BLINK_OFF);
-    return;
-  }
+void dualjoy_config_changed(const uint8_t param) {
+  const bool all = param == DJ_PARAM_NUM;
 
-  // blink is disabled
-  if (blink_interval_us == BLINK_OFF) return;
+  if (all || param == DJ_PARAM_DEBOUNCE_MODE || param == DJ_PARAM_DEBOUNCE_US) {
+    input_setup_debounce();
+    if (config.debounce_mode == DEBOUNCE_OVERSAMPLE) {
+      oversample_init(config.oversample_khz * 1000);
+    }
+  }
+  if (all || param == DJ_PARAM_AUTOFIRE_HZ || param == DJ_PARAM_AUTOFIRE_DUTY) {
+    autofire_setup();
+  }
+  if (all || param == DJ_PARAM_MOUSE_SPEED || param == DJ_PARAM_MOUSE_ACCEL_MS) {
+    mouse_setup(usb_active_mode() == USB_MODE_MOUSE);
+  }
+  if (all || param == DJ_PARAM_PORT_PROTOCOL || param == DJ_PARAM_DIR_MODE ||
+      param == DJ_PARAM_SOCD_MODE || param == DJ_PARAM_AUTOFIRE_HZ || param == DJ_PARAM_AUTOFIRE_DUTY) {
+    input_setup_decoders();
+    for (uint8_t p = 0; p < PORT_NUM; p++) {
+      decoded[p] = input_decode(p);
+      autofire_button(p, decoded[p].buttons);
+    }
+  }
+  // a recorded trace only replays with the config it was recorded with
+  reset_trace();
+}
 
-  // Blink every interval ms
-  if (!reached(next_us)) return; // not enough time
+void dualjoy_request_save(void) {
+  save_requested = true;
+  persist_pending = true;
+}
 
-  next_us = time_after_us(blink_interval_us);
+uint32_t dualjoy_debounce_window(const uint8_t pin) {
+  return input_debounce_window(pin);
+}
 
-  // TOGGLE
-  led_state = !led_state;
-  board_led_write(led_state);
+void dualjoy_reset_trace(void) {
+  reset_trace();
 }
 
 //--------------------------------------------------------------------+
@@ -324,14 +330,18 @@ static inline void led_blinking_task()
 void tud_mount_cb(void)
 {
   trace("%s called\n", __func__);
-  led_blink_fast_until(time_after_us(1000 * 1000));
+  if (!boot.done_us[DJ_BOOT_MOUNTED]) boot.done_us[DJ_BOOT_MOUNTED] = time_us_32();
+  select_reports(usb_mode_activate());
+  // the host doesn't know the state yet, send it even if all is idle
+  reports_resend();
+  led_set_after(LED_MOUNTED, LED_OFF);
 }
 
 // Invoked when device is unmounted
 void tud_umount_cb(void)
 {
   trace("%s called\n", __func__);
-  led_set_blink_mode(BLINK_NOT_MOUNTED);
+  led_set(LED_NOT_MOUNTED);
 }
 
 // Invoked when usb bus is suspended
@@ -340,7 +350,7 @@ void tud_umount_cb(void)
 void tud_suspend_cb(bool)
 {
   trace("%s called\n", __func__);
-  led_set_blink_mode(BLINK_SUSPENDED);
+  led_set(LED_SUSPENDED);
 }
 
 // Invoked when usb bus is resumed
@@ -348,18 +358,33 @@ void tud_resume_cb(void)
 {
   trace("%s called\n", __func__);
   if (tud_mounted()) {
-    led_blink_fast_until(time_after_us(500 * 1000));
+    led_set_after(LED_RESUMED, LED_OFF);
   } else {
-   led_set_blink_mode(BLINK_NOT_MOUNTED);
+    led_set(LED_NOT_MOUNTED);
   }
 }
 
+// Invoked on every start of frame, only enabled while autofire waits for a
+// SOF to align its phases
+void tud_sof_cb(uint32_t frame_count)
+{
+  autofire_sof();
+}
+
 // Invoked when sent REPORT successfully to host
 // Application can use this to send the next report
 // Note: For composite reports, report[0] is report ID
 void tud_hid_report_complete_cb(uint8_t instance, uint8_t const* report, uint16_t len)
 {
   trace("%s instance:%d\n", __func__, instance);
+
+  report_completed(reports_ports(instance));
+}
+
+// Invoked when the host picked up an XInput report
+void xinput_report_complete_cb(uint8_t port)
+{
+  report_completed(1 << port);
 }
 
 // Invoked when received GET_REPORT control request
@@ -367,15 +392,26 @@ void tud_hid_report_complete_cb(uint8_t instance, uint8_t const* report, uint16_
 // Return zero will cause the stack to STALL request
 uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t* buffer, uint16_t reqlen)
 {
-  trace("%s called\n", __func__);
-  return 0;
+  trace("%s instance:%d id:%d type:%d\n", __func__, instance, report_id, report_type);
+
+  if (report_type == HID_REPORT_TYPE_FEATURE && report_id == DJ_FEATURE_REPORT_ID) {
+    return protocol_get_report(buffer, reqlen);
+  }
+
+  if (report_type != HID_REPORT_TYPE_INPUT) return 0;
+
+  // TinyUSB already put the report ID in front of buffer
+  return reports_get(instance, report_id, buffer, reqlen);
 }
 
 // Invoked when received SET_REPORT control request or
 // received data on OUT endpoint ( Report ID = 0, Type = 0 )
 void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const* buffer, uint16_t bufsize)
 {
-  trace("%s called\n", __func__);
+  trace("%s instance:%d id:%d type:%d\n", __func__, instance, report_id, report_type);
+
+  if (report_type != HID_REPORT_TYPE_FEATURE || report_id != DJ_FEATURE_REPORT_ID) return;
+  protocol_set_report(buffer, bufsize);
 }
 
 
@@ -387,34 +423,52 @@ int main(void)
   trace("DualJoy starting...\n");
 
   board_init();
+  led_init();
+  boot.done_us[DJ_BOOT_BOARD] = time_us_32();
 
-  sleep_ms(10);
+  if (!config_load()) {
+    trace("no valid config stored, using defaults\n");
+  }
+  input_setup_pins();
+  input_setup_decoders();
+  usb_latch_config();
+  setup_reports();
+  select_reports(usb_active_mode());
+  input_setup_debounce();
+  reset_trace();
+  autofire_setup();
+  profile_init();
+  boot.done_us[DJ_BOOT_CONFIG] = time_us_32();
+
+  // sample before the USB setup, so sticks held at plug-in are seen
+  setup_gpios();
+
+  if (config.debounce_mode == DEBOUNCE_OVERSAMPLE) {
+    oversample_init(config.oversample_khz * 1000);
+  }
+  update_states_task();
+  boot.done_us[DJ_BOOT_GPIOS] = time_us_32();
 
   // init device stack on configured roothub port
   tud_init(BOARD_TUD_RHPORT);
 
-  sleep_ms(10);
-
   if (board_init_after_tusb) {
     board_init_after_tusb();
   }
-
-  sleep_ms(10);
-
-  setup_gpios();
-
-  sleep_ms(10);
-
-  while (!tud_mounted()) {
-    tud_task(); // tinyusb device task
-    led_blinking_task();
-  }
+  boot.done_us[DJ_BOOT_USB] = time_us_32();
 
   while (1) {
+    const uint32_t loop_start = time_us_32();
     tud_task(); // tinyusb device task
-    led_blinking_task();
+    PROFILE_BEGIN(DJ_PROFILE_UPDATE_STATES);
     update_states_task();
-    sleep_ms(1); // ~= 1000Hz sampling
+    PROFILE_END(DJ_PROFILE_UPDATE_STATES);
+    persist_task();
+    governor_task(counters.edges);
+    led_task();
+    count_loop(loop_start);
+    if (!tud_mounted()) continue; // don't delay the enumeration
+    loop_wait(); // ~= 1000Hz sampling
     if (tud_suspended()) {
       sleep_ms(100);
     }
@@ -26,6 +26,8 @@
 #ifndef USB_DESCRIPTORS_H_
 #define USB_DESCRIPTORS_H_
 
+#include <stdint.h>
+
 // enum
 // {
 //   REPORT_ID_KEYBOARD = 1,
@@ -37,8 +39,96 @@
 
 #define JOYSTICK_REPORT_ID  0x04
 #define JOYSTICK2_REPORT_ID 0x05
+#define KEYBOARD_REPORT_ID  0x06
+#define MOUSE_REPORT_ID     0x07
+#define COMBINED_REPORT_ID  0x08
+
+#define HID_POLL_INTERVAL_MS 5
+
+// the NKRO keyboard report has a bit for each key usage below KEYBOARD_KEY_NUM
+// (up to Keypad =), plus the modifiers 0xE0-0xE7 in their own byte
+#define KEYBOARD_KEY_NUM 104
+#define KEYBOARD_MODIFIER_FIRST 0xE0
+#define KEYBOARD_MODIFIER_LAST 0xE7
+
+// Every mode is a USB configuration. Configuration 1 is config.usb_mode as of
+// the boot, the others follow in this order, so the host can switch with
+// SET_CONFIGURATION.
+enum usb_mode {
+  USB_MODE_GAMEPAD = 0, // one HID gamepad per port
+  USB_MODE_KEYBOARD,    // both ports on a NKRO keyboard, see config.keys
+  USB_MODE_XINPUT,      // one XInput controller per port
+  USB_MODE_MOUSE,       // config.mouse_port moves a mouse, the other port's button is the right button
+  USB_MODE_COMBINED,    // both ports on one gamepad with two hats
+  USB_MODE_NUM,
+};
+
+// implemented in usb_descriptors.c
+
+// latches config.usb_mode and config.poll_interval_ms for the descriptors,
+// call once at boot before tud_init(), a later SET of them applies after the
+// next reboot
+void usb_latch_config(void);
+// the HID endpoint polling interval the host got
+uint8_t usb_poll_interval_ms(void);
+// latches the mode of the configuration the host just selected, call when
+// the device got mounted
+uint8_t usb_mode_activate(void);
+// the mode of the current configuration
+uint8_t usb_active_mode(void);
+
+enum pin {
+  UP = 0,
+  DOWN,
+  LEFT,
+  RIGHT,
+  BTN,
+  PIN_NUM,
+  PORT_NUM = 2,
+  TOTAL_PIN_NUM = PIN_NUM * PORT_NUM,
+};
+
+enum port_protocol {
+  PORT_JOYSTICK = 0,   // Atari/C64/Amiga style digital joystick
+  PORT_DISABLED,       // the port always reports the idle state
+  PORT_PROTOCOL_NUM,
+};
+
+enum dir_mode {
+  DIR_8WAY = 0,
+  DIR_4WAY,            // diagonals resolve to the vertical direction
+  DIR_MODE_NUM,
+};
+
+// simultaneous opposing directions (SOCD) resolution
+enum socd_mode {
+  SOCD_UP_RIGHT = 0,   // up wins over down, right wins over left
+  SOCD_NEUTRAL,        // opposing directions cancel each other
+  SOCD_UP_PRIORITY,    // up wins over down, left and right cancel each other
+  SOCD_LAST_WINS,      // the most recently pressed direction wins
+  SOCD_MODE_NUM,
+};
+
+enum debounce_mode {
+  DEBOUNCE_FIXED = 0,  // same lockout window for every pin
+  DEBOUNCE_ADAPTIVE,   // per pin window learned from the observed bounce bursts
+  DEBOUNCE_OVERSAMPLE, // no lockout, majority vote over DMA paced oversampling
+};
+
+enum {
+  DEBOUNCE_TIMEOUT_US = 20 * 1000, // default fixed window and adaptive start value
+  DEBOUNCE_MIN_US = 1 * 1000,      // bounds of the adaptive window
+  DEBOUNCE_MAX_US = 30 * 1000,
+};
+
+enum {
+  MOUSE_SPEED_MIN = 10,     // bounds of config.mouse_speed, pixels per second
+  MOUSE_SPEED_MAX = 5000,
+  MOUSE_ACCEL_MAX_MS = 5000,
+};
 
-#if defined(LIB_PICO_STDIO_USB) || defined(LIB_PICO_STDIO_UART)
+// DUALJOY_NO_TRACE keeps the stdio for other output, like in the benchmark
+#if !DUALJOY_NO_TRACE && (defined(LIB_PICO_STDIO_USB) || defined(LIB_PICO_STDIO_UART))
 #define trace(...) printf(__VA_ARGS__)
 #else
 #define trace(...) do {} while(0)
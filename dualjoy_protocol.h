@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef DUALJOY_PROTOCOL_H_
+#define DUALJOY_PROTOCOL_H_
+
+// Binary configuration and telemetry protocol, carried in a vendor defined
+// feature report on the first HID interface. Shared by the firmware and the
+// host tools.
+//
+// The host sends a request with SET_REPORT(feature) and fetches the answer
+// with GET_REPORT(feature). The device handles every request right away and
+// keeps the answer until the next request. GET and READ have no side effects
+// and SET writes absolute values, so any transaction can simply be repeated.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dualjoy.h"
+
+#define DJ_FEATURE_REPORT_ID 0x10
+#define DJ_BLOCK_WORDS 5 // words per READ answer
+
+enum dj_cmd {
+  DJ_CMD_NOP = 0,
+  DJ_CMD_GET,          // value = param id[index]
+  DJ_CMD_SET,          // param id[index] = value
+  DJ_CMD_SAVE,         // write the config to flash once the sticks are idle
+  DJ_CMD_DEFAULTS,     // restore the default config (not saved)
+  DJ_CMD_READ,         // data = words value... of block id
+  DJ_CMD_RESET,        // reset block id
+};
+
+enum dj_status {
+  DJ_OK = 0,
+  DJ_ERR_CMD,          // unknown command
+  DJ_ERR_ID,           // unknown param or block
+  DJ_ERR_INDEX,        // index out of range
+  DJ_ERR_VALUE,        // value rejected by the config validation
+  DJ_ERR_READONLY,
+};
+
+// X(id, name, count, field): params, their names in the host tool, how many
+// instances (ports or pins) they have and their field in dualjoy_config.
+// Params marked with * in the comments are only applied after a reboot.
+#define DJ_PARAMS(X) \
+  X(DJ_PARAM_GPIO,             "gpio",             TOTAL_PIN_NUM, gpios) /* * */ \
+  X(DJ_PARAM_DEBOUNCE_MODE,    "debounce_mode",    1,             debounce_mode) \
+  X(DJ_PARAM_DEBOUNCE_US,      "debounce_us",      1,             debounce_us) \
+  X(DJ_PARAM_DEBOUNCE_WINDOW,  "debounce_window",  TOTAL_PIN_NUM, learned_debounce_us) /* current window, read only */ \
+  X(DJ_PARAM_OVERSAMPLE_KHZ,   "oversample_khz",   1,             oversample_khz) /* * */ \
+  X(DJ_PARAM_VOTE_M,           "vote_m",           1,             vote_m) \
+  X(DJ_PARAM_VOTE_N,           "vote_n",           1,             vote_n) \
+  X(DJ_PARAM_POLL_INTERVAL_MS, "poll_interval_ms", 1,             poll_interval_ms) /* * */ \
+  X(DJ_PARAM_PORT_PROTOCOL,    "port_protocol",    PORT_NUM,      port_protocol) \
+  X(DJ_PARAM_DIR_MODE,         "dir_mode",         PORT_NUM,      dir_mode) \
+  X(DJ_PARAM_SOCD_MODE,        "socd_mode",        PORT_NUM,      socd_mode) \
+  X(DJ_PARAM_AUTOFIRE_HZ,      "autofire_hz",      PORT_NUM,      autofire_hz) \
+  X(DJ_PARAM_AUTOFIRE_DUTY,    "autofire_duty",    PORT_NUM,      autofire_duty) \
+  X(DJ_PARAM_CLOCK_GOVERNOR,   "clock_governor",   1,             clock_governor) \
+  X(DJ_PARAM_USB_MODE,         "usb_mode",         1,             usb_mode) /* * */ \
+  X(DJ_PARAM_KEY,              "key",              TOTAL_PIN_NUM, keys) \
+  X(DJ_PARAM_MOUSE_PORT,       "mouse_port",       1,             mouse_port) \
+  X(DJ_PARAM_MOUSE_SPEED,      "mouse_speed",      1,             mouse_speed) \
+  X(DJ_PARAM_MOUSE_ACCEL_MS,   "mouse_accel_ms",   1,             mouse_accel_ms)
+
+#define DJ_PARAM_ENUM(_id, _name, _count, _field) _id,
+enum dj_param {
+  DJ_PARAMS(DJ_PARAM_ENUM)
+  DJ_PARAM_NUM,
+};
+#undef DJ_PARAM_ENUM
+
+enum dj_block {
+  DJ_BLOCK_COUNTERS = 0,
+  DJ_BLOCK_HISTOGRAMS,
+  DJ_BLOCK_PROFILE,     // only in the dualjoy_profile build
+  DJ_BLOCK_BOOT,
+  DJ_BLOCK_TRACE,
+  DJ_BLOCK_NUM,
+};
+
+typedef struct __attribute__((packed)) {
+  uint8_t cmd;         // enum dj_cmd
+  uint8_t status;      // enum dj_status, set in the answer
+  uint8_t id;          // enum dj_param or enum dj_block
+  uint8_t index;       // port or pin of a param
+  uint8_t seq;         // echoed in the answer
+  uint8_t count;       // number of valid words in data
+  uint16_t reserved;
+  uint32_t value;      // of a param, first word of a block
+  uint32_t data[DJ_BLOCK_WORDS];
+} dj_feature;
+
+// DJ_BLOCK_COUNTERS, all counters wrap around, the *_max_us values are
+// maxima since the last reset
+typedef struct {
+  uint32_t loops;                       // main loop iterations
+  uint32_t loop_time_us;                // time spent in the main loop, without the sleep
+  uint32_t loop_time_max_us;
+  uint32_t samples;                     // pin samples
+  uint32_t edges;                       // accepted (debounced) pin edges
+  uint32_t rejections[TOTAL_PIN_NUM];   // changes ignored by the debouncing, per pin
+  uint32_t reports;                     // reports queued with tud_hid_n_report()
+  uint32_t report_failures;             // tud_hid_n_report() failures
+  uint32_t edge_latency_max_us;         // from the first edge of a port to its queued report
+} dj_counters;
+
+// DJ_BLOCK_HISTOGRAMS, latencies from the first debounced edge of a port to
+// the report containing it. Bucket 0 counts latencies below 2 us, bucket n
+// latencies from 2^n to 2^(n+1)-1 us, the last bucket everything above.
+#define DJ_HIST_BUCKETS 16
+
+typedef struct {
+  uint32_t queued[PORT_NUM][DJ_HIST_BUCKETS];     // accepted by tud_hid_n_report()
+  uint32_t completed[PORT_NUM][DJ_HIST_BUCKETS];  // tud_hid_report_complete_cb() fired
+} dj_histograms;
+
+// DJ_BLOCK_PROFILE, CPU cycles spent per call. update_states_task includes
+// send_states, which is called from it.
+#define DJ_PROFILE_OUTLIERS 4
+
+enum dj_profile_slot_id {
+  DJ_PROFILE_UPDATE_STATES = 0,
+  DJ_PROFILE_SEND_STATES,
+  DJ_PROFILE_SLOTS,
+};
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint32_t total_lo;                          // 64 bit sum of all cycles
+  uint32_t total_hi;
+  uint32_t outliers[DJ_PROFILE_OUTLIERS];     // largest samples, descending
+  uint32_t outlier_us[DJ_PROFILE_OUTLIERS];   // time_us_32() when they were taken
+} dj_profile_slot;
+
+typedef struct {
+  uint32_t cpu_hz;
+  dj_profile_slot slots[DJ_PROFILE_SLOTS];
+} dj_profile;
+
+// DJ_BLOCK_BOOT, time_us_32() at the end of each boot phase, 0 if it didn't
+// end yet. The timer starts at reset, so the first phase includes the boot rom.
+enum dj_boot_phase {
+  DJ_BOOT_BOARD = 0,    // clocks, stdio and board init
+  DJ_BOOT_CONFIG,       // config load and the derived tables
+  DJ_BOOT_GPIOS,        // pins set up and settled, first sample taken
+  DJ_BOOT_USB,          // device stack initialized
+  DJ_BOOT_MOUNTED,      // host set the configuration
+  DJ_BOOT_FIRST_REPORT, // first report queued
+  DJ_BOOT_PHASES,
+};
+
+typedef struct {
+  uint32_t done_us[DJ_BOOT_PHASES];
+} dj_boot;
+
+// DJ_BLOCK_TRACE, a ring of the samples the debouncing got, for the replay
+// tool. A sample is recorded if it differs from the previous one or from the
+// debounced state, all others don't change anything. The ring restarts when
+// the config changes, so it always matches the current config, and it keeps
+// the lockout windows and GPIOs in force at the restart, which the config
+// params don't tell. A READ at offset 0 freezes the recording until the next
+// RESET, so a dump taken in several READs is consistent.
+#define DJ_TRACE_LEN 1024
+
+typedef struct {
+  uint32_t time_us;
+  uint32_t pins;       // the sample, bit n set if GPIO n is active
+  uint32_t states;     // the debounced states before the sample
+} dj_trace_entry;
+
+typedef struct {
+  uint32_t count;      // entries recorded since the reset, once the ring
+                       // wrapped the oldest one is at count % DJ_TRACE_LEN
+  uint32_t windows_us[TOTAL_PIN_NUM];  // lockout window of each pin at the reset
+  uint8_t gpios[TOTAL_PIN_NUM];        // the sampled GPIOs, gpio applies after a reboot
+  uint8_t frozen;                      // nothing is recorded while set
+  uint8_t reserved;
+  dj_trace_entry entries[DJ_TRACE_LEN];
+} dj_trace;
+
+_Static_assert(offsetof(dj_trace, entries) % sizeof(uint32_t) == 0, "the trace is read in words");
+
+#endif /* DUALJOY_PROTOCOL_H_ */
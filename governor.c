@@ -0,0 +1,94 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/uart.h"
+
+#include "config.h"
+#include "governor.h"
+#include "led.h"
+#include "oversample.h"
+#include "profile.h"
+
+enum {
+  GOVERNOR_WINDOW_US = 100 * 1000,  // edge rate measuring window
+  GOVERNOR_BOOST_EDGES = 20,        // edges per window that ask for full speed
+  GOVERNOR_HOLD_US = 2000 * 1000,   // minimum time at full speed after a boost
+};
+
+static bool boosted = true; // the SDK boots at SYS_CLK_KHZ
+static uint32_t window_start_us = 0;
+static uint32_t window_edges = 0;
+static bool holding = false;       // hold_until_us is valid
+static uint32_t hold_until_us = 0;
+
+static void set_speed(const bool boost) {
+  if (boost == boosted) return;
+#if defined(LIB_PICO_STDIO_UART)
+  // both switches move clk_peri along with clk_sys, don't garble the output
+  // that is still in the FIFO
+  uart_tx_wait_blocking(uart_default);
+#endif
+  if (boost) {
+    set_sys_clock_khz(SYS_CLK_KHZ, true);
+  } else {
+    set_sys_clock_48mhz();
+  }
+  boosted = boost;
+#if defined(LIB_PICO_STDIO_UART)
+  // the baud rate divider is derived from clk_peri
+  uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+#endif
+  // the PIO programs are paced by clk_sys
+  oversample_clock_changed();
+  led_clock_changed();
+  profile_clock_changed();
+}
+
+void governor_boost(void) {
+  hold_until_us = time_us_32() + GOVERNOR_HOLD_US;
+  holding = true;
+  set_speed(true);
+}
+
+void governor_task(const uint32_t edges) {
+  if (!config.clock_governor) {
+    set_speed(true);
+    return;
+  }
+
+  const uint32_t now = time_us_32();
+  if (now - window_start_us >= GOVERNOR_WINDOW_US) {
+    // the counters were reset, the window starts over
+    if (edges < window_edges) window_edges = edges;
+    if (edges - window_edges >= GOVERNOR_BOOST_EDGES) governor_boost();
+    window_start_us = now;
+    window_edges = edges;
+  }
+  // only compared while it is less than GOVERNOR_HOLD_US away, so the
+  // comparison is safe across the wraparound of the timer
+  if (holding && (int32_t)(now - hold_until_us) >= 0) holding = false;
+  if (!holding) set_speed(false);
+}
@@ -0,0 +1,335 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "input.h"
+#include "config.h"
+#include "protocol.h"
+
+enum {
+  MAX_DELAY_US = 2500 * 1000, // must be set to the largest wait interval
+};
+
+// The GPIO mapping is loaded from the config store at boot (see config.c for
+// the default wiring). All masks and reverse lookups are derived from it once
+// in input_setup_pins(), so the sampling path only does plain table lookups.
+// A changed mapping only applies after a reboot, so everything else derived
+// from the GPIOs uses the copy latched there, not config.gpios.
+
+static uint8_t pin_gpios[TOTAL_PIN_NUM];  // config.gpios at boot, the sampled ones
+static uint32_t inputMasks[TOTAL_PIN_NUM];
+static uint32_t port_masks[PORT_NUM];
+static uint32_t pin_mask;
+static uint8_t gpio2pin[32];
+
+static uint32_t pin_states = 0;
+static uint32_t decoded_states = 0;   // pin_states at the last input_decode_changed()
+static uint32_t pin_timeouts[TOTAL_PIN_NUM] = { 0 };
+static uint32_t pin_edges[TOTAL_PIN_NUM] = { 0 };   // time of the last accepted edge
+static uint32_t pin_bounces[TOTAL_PIN_NUM] = { 0 }; // offset of the last rejected change after that edge
+static uint32_t pin_debounce_us[TOTAL_PIN_NUM];     // lockout window of each pin
+static uint32_t idle_us = 0;          // the sticks count as idle once reached
+
+static inline bool reached(const uint32_t t, const uint32_t now) {
+  // overflow safe time comparison
+  return t == 0 || t - now > MAX_DELAY_US;
+}
+
+static inline uint32_t time_after_us(uint32_t us, const uint32_t now) {
+  if (us > MAX_DELAY_US) us = MAX_DELAY_US;
+  return (now + us) | 1; // make sure it's never 0 after overflow
+}
+
+// The state of a port is decoded into its report with a single lookup in a 32
+// entry table, indexed by the 5 pin states. The tables for all direction and
+// SOCD modes are generated by the preprocessor from the logical port state
+// (bit n set if enum pin n is active).
+
+#define HAT(s) \
+  (((s) & S(UP)) ? \
+    (((s) & S(RIGHT)) ? 1 /* NE */ : ((s) & S(LEFT)) ? 7 /* NW */ : 0 /* N */) : \
+  ((s) & S(DOWN)) ? \
+    (((s) & S(RIGHT)) ? 3 /* SE */ : ((s) & S(LEFT)) ? 5 /* SW */ : 4 /* S */) : \
+  ((s) & S(RIGHT)) ? 2 /* E */ : \
+  ((s) & S(LEFT)) ? 6 /* W */ : \
+  8) /* Center (null state, outside logical range 0-7) */
+
+// SOCD_UP_RIGHT is what HAT() does anyway
+#define SOCD_UP_RIGHT_FN(s) (s)
+#define BOTH(s, a, b) (((s) & (S(a) | S(b))) == (S(a) | S(b)))
+#define SOCD_NEUTRAL_FN(s) \
+  ((s) & ~(BOTH(s, UP, DOWN) ? S(UP) | S(DOWN) : 0) & ~(BOTH(s, LEFT, RIGHT) ? S(LEFT) | S(RIGHT) : 0))
+#define SOCD_UP_PRIORITY_FN(s) \
+  ((s) & ~(BOTH(s, UP, DOWN) ? S(DOWN) : 0) & ~(BOTH(s, LEFT, RIGHT) ? S(LEFT) | S(RIGHT) : 0))
+// the older of two opposing directions is already removed by socd_last_wins()
+#define SOCD_LAST_WINS_FN(s) (s)
+
+#define DIR_8WAY_FN(s) (s)
+#define DIR_4WAY_FN(s) (((s) & (S(UP) | S(DOWN))) ? (s) & ~(S(LEFT) | S(RIGHT)) : (s))
+
+#define DECODE(s, dir, socd) { .direction = HAT(dir(socd(s))), .buttons = ((s) & S(BTN)) ? 1 : 0 }
+
+#define DECODE_TABLE(dir, socd) { \
+  DECODE( 0, dir, socd), DECODE( 1, dir, socd), DECODE( 2, dir, socd), DECODE( 3, dir, socd), \
+  DECODE( 4, dir, socd), DECODE( 5, dir, socd), DECODE( 6, dir, socd), DECODE( 7, dir, socd), \
+  DECODE( 8, dir, socd), DECODE( 9, dir, socd), DECODE(10, dir, socd), DECODE(11, dir, socd), \
+  DECODE(12, dir, socd), DECODE(13, dir, socd), DECODE(14, dir, socd), DECODE(15, dir, socd), \
+  DECODE(16, dir, socd), DECODE(17, dir, socd), DECODE(18, dir, socd), DECODE(19, dir, socd), \
+  DECODE(20, dir, socd), DECODE(21, dir, socd), DECODE(22, dir, socd), DECODE(23, dir, socd), \
+  DECODE(24, dir, socd), DECODE(25, dir, socd), DECODE(26, dir, socd), DECODE(27, dir, socd), \
+  DECODE(28, dir, socd), DECODE(29, dir, socd), DECODE(30, dir, socd), DECODE(31, dir, socd), \
+}
+
+static const report decode_tables[DIR_MODE_NUM][SOCD_MODE_NUM][1 << PIN_NUM] = {
+  [DIR_8WAY] = {
+    [SOCD_UP_RIGHT] = DECODE_TABLE(DIR_8WAY_FN, SOCD_UP_RIGHT_FN),
+    [SOCD_NEUTRAL] = DECODE_TABLE(DIR_8WAY_FN, SOCD_NEUTRAL_FN),
+    [SOCD_UP_PRIORITY] = DECODE_TABLE(DIR_8WAY_FN, SOCD_UP_PRIORITY_FN),
+    [SOCD_LAST_WINS] = DECODE_TABLE(DIR_8WAY_FN, SOCD_LAST_WINS_FN),
+  },
+  [DIR_4WAY] = {
+    [SOCD_UP_RIGHT] = DECODE_TABLE(DIR_4WAY_FN, SOCD_UP_RIGHT_FN),
+    [SOCD_NEUTRAL] = DECODE_TABLE(DIR_4WAY_FN, SOCD_NEUTRAL_FN),
+    [SOCD_UP_PRIORITY] = DECODE_TABLE(DIR_4WAY_FN, SOCD_UP_PRIORITY_FN),
+    [SOCD_LAST_WINS] = DECODE_TABLE(DIR_4WAY_FN, SOCD_LAST_WINS_FN),
+  },
+};
+
+// If the pins of a port are on 5 consecutive GPIOs, the raw GPIO window is
+// used as table index directly and the pin order is folded into the table.
+// Otherwise the pin states are gathered into the logical port state.
+typedef struct {
+  bool contiguous;
+  bool last_wins;              // SOCD_LAST_WINS, resolved with the edge timestamps
+  uint8_t shift;               // lowest GPIO of the port
+  uint8_t bits[PIN_NUM];       // index bit of each pin
+  report table[1 << PIN_NUM];
+} port_decoder;
+
+static port_decoder decoders[PORT_NUM];
+
+void input_setup_decoders(void) {
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    port_decoder *d = &decoders[p];
+    const uint8_t *gpios = &pin_gpios[p * PIN_NUM];
+
+    d->shift = 31;
+    for (uint8_t i = 0; i < PIN_NUM; i++) {
+      if (gpios[i] < d->shift) d->shift = gpios[i];
+    }
+    d->contiguous = (port_masks[p] >> d->shift) == (1 << PIN_NUM) - 1;
+    for (uint8_t i = 0; i < PIN_NUM; i++) {
+      d->bits[i] = d->contiguous ? gpios[i] - d->shift : i;
+    }
+    d->last_wins = config.socd_mode[p] == SOCD_LAST_WINS;
+
+    const bool disabled = config.port_protocol[p] == PORT_DISABLED;
+    const report *table = decode_tables[config.dir_mode[p]][config.socd_mode[p]];
+    for (uint8_t raw = 0; raw < (1 << PIN_NUM); raw++) {
+      uint8_t s = 0;
+      for (uint8_t i = 0; i < PIN_NUM; i++) {
+        if (raw & (1 << d->bits[i])) s |= S(i);
+      }
+      d->table[raw] = table[disabled ? 0 : s];
+    }
+  }
+}
+
+// removes the older one of two opposing directions from the table index
+static inline uint32_t socd_last_wins(const port_decoder *d, const uint32_t *edges, uint32_t index) {
+  const uint32_t up = 1 << d->bits[UP], down = 1 << d->bits[DOWN];
+  const uint32_t left = 1 << d->bits[LEFT], right = 1 << d->bits[RIGHT];
+
+  if ((index & (up | down)) == (up | down))
+    index &= ~((int32_t)(edges[UP] - edges[DOWN]) > 0 ? down : up);
+  if ((index & (left | right)) == (left | right))
+    index &= ~((int32_t)(edges[LEFT] - edges[RIGHT]) > 0 ? right : left);
+  return index;
+}
+
+report input_decode(const uint8_t p) {
+  const port_decoder *d = &decoders[p];
+  uint32_t index;
+
+  if (d->contiguous) {
+    index = (pin_states >> d->shift) & ((1 << PIN_NUM) - 1);
+  } else {
+    const uint32_t *masks = &inputMasks[p * PIN_NUM];
+    index = 0;
+    for (uint8_t i = 0; i < PIN_NUM; i++) {
+      if (pin_states & masks[i]) index |= S(i);
+    }
+  }
+  if (d->last_wins) {
+    index = socd_last_wins(d, &pin_edges[p * PIN_NUM], index);
+  }
+  return d->table[index];
+}
+
+static inline uint8_t fast_log2_of_pow2(const uint32_t x) {
+    static const uint32_t deBruijnSequence = 0x077CB531U;
+    static const uint8_t lookupTable[32] = {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+    // Multiply by de Bruijn sequence
+    return lookupTable[((x * deBruijnSequence) >> 27)];
+}
+
+void input_setup_pins(void) {
+  pin_mask = 0;
+  memset(port_masks, 0, sizeof(port_masks));
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    const uint8_t gpio = config.gpios[i];
+    pin_gpios[i] = gpio;
+    inputMasks[i] = 1u << gpio;
+    gpio2pin[gpio] = i;
+    port_masks[i / PIN_NUM] |= inputMasks[i];
+    pin_mask |= inputMasks[i];
+  }
+}
+
+void input_setup_debounce(void) {
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    if (config.debounce_mode == DEBOUNCE_OVERSAMPLE)
+      pin_debounce_us[i] = 0; // the vote filters the glitches
+    else if (config.debounce_mode == DEBOUNCE_ADAPTIVE && config.learned_debounce_us[i])
+      pin_debounce_us[i] = config.learned_debounce_us[i];
+    else
+      pin_debounce_us[i] = config.debounce_us;
+  }
+}
+
+uint32_t input_pin_mask(void) {
+  return pin_mask;
+}
+
+uint32_t input_states(void) {
+  return pin_states;
+}
+
+void input_preset(const uint32_t states) {
+  pin_states = states & pin_mask;
+  memset(pin_timeouts, 0, sizeof(pin_timeouts));
+  memset(pin_edges, 0, sizeof(pin_edges));
+  memset(pin_bounces, 0, sizeof(pin_bounces));
+}
+
+// Called when pin p accepts a new edge, evaluates the bounce burst seen in
+// the lockout window of the previous edge. The window grows immediately if
+// the bounce got close to its end (or escaped it), and shrinks slowly towards
+// twice the burst length if the switch settles earlier.
+static inline void debounce_learn(const uint8_t p, const uint32_t now) {
+  const uint32_t window = pin_debounce_us[p];
+  const uint32_t burst = pin_bounces[p];
+  uint32_t target = 2 * burst + DEBOUNCE_MIN_US / 2;
+
+  if (burst && (burst > window * 3 / 4 || now - pin_edges[p] < window + DEBOUNCE_MIN_US))
+    target = 2 * window;
+
+  uint32_t w = (target > window) ? target : window - (window - target) / 16;
+  if (w < DEBOUNCE_MIN_US) w = DEBOUNCE_MIN_US;
+  if (w > DEBOUNCE_MAX_US) w = DEBOUNCE_MAX_US;
+
+  if (w != window) {
+    trace("%s pin %d burst %lu window %lu -> %lu\n", __func__, p, burst, window, w);
+    pin_debounce_us[p] = w;
+  }
+}
+
+// The lockout and idle times are absolute 32 bit times, after ~71 minutes
+// without an edge they would look pending again and hold back the next edge
+// for up to MAX_DELAY_US. Every sample clears one of them once it passed, so
+// they are all cleared long before that.
+static inline void expire_times(const uint32_t now) {
+  static uint8_t next = 0;
+
+  if (next < TOTAL_PIN_NUM) {
+    if (reached(pin_timeouts[next], now)) pin_timeouts[next] = 0;
+  } else if (reached(idle_us, now)) {
+    idle_us = 0;
+  }
+  next = next < TOTAL_PIN_NUM ? next + 1 : 0;
+}
+
+uint8_t input_update(const uint32_t pins, const uint32_t now) {
+  uint32_t changes = pins ^ pin_states;
+  uint8_t edge_ports = 0;
+
+  counters.samples++;
+  expire_times(now);
+
+  // beware, here comes some serious over-engineering
+  while (changes) {
+    trace("%s pins: %.32b pin_states: %.32b changes: %.32b\n", __func__, pins, pin_states, changes);
+    const uint32_t mask = changes & -changes; // isolate least significant changed bit
+    changes &= ~mask; // remove that bit from changes
+    const uint8_t i = fast_log2_of_pow2(mask); // calculate bit position
+    const uint8_t p = gpio2pin[i];
+    if (reached(pin_timeouts[p], now)) {
+      trace("%s changing pin_state %d to %d\n", __func__, i, !(pin_states & mask));
+      if (config.debounce_mode == DEBOUNCE_ADAPTIVE) debounce_learn(p, now);
+      pin_states ^= mask;
+      pin_edges[p] = now;
+      idle_us = time_after_us(MAX_DELAY_US, now);
+      counters.edges++;
+      edge_ports |= 1 << (p / PIN_NUM);
+      pin_bounces[p] = 0;
+      pin_timeouts[p] = time_after_us(pin_debounce_us[p], now);
+    } else {
+        trace("%s skipping pin_state %d because recent change\n", __func__, i);
+        pin_bounces[p] = now - pin_edges[p];
+        counters.rejections[p]++;
+    }
+  }
+  return edge_ports;
+}
+
+uint8_t input_decode_changed(report decoded[PORT_NUM]) {
+  const uint32_t changes = decoded_states ^ pin_states;
+  uint8_t ports = 0;
+
+  if (!changes) return 0;
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (changes & port_masks[p]) {
+      decoded[p] = input_decode(p);
+      ports |= 1 << p;
+    }
+  }
+  decoded_states = pin_states;
+  return ports;
+}
+
+uint32_t input_debounce_window(const uint8_t pin) {
+  return pin_debounce_us[pin];
+}
+
+uint8_t input_gpio(const uint8_t pin) {
+  return pin_gpios[pin];
+}
+
+bool input_idle(const uint32_t now) {
+  return reached(idle_us, now);
+}
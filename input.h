@@ -0,0 +1,83 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dualjoy.h"
+
+// The input pipeline: debouncing of the sampled pins and decoding of the
+// ports into their states. It only depends on the config, so it builds for
+// the host as well, where the replay tool feeds recorded samples through it.
+
+typedef struct {
+  uint8_t direction;   // hat value, 8 = center
+  uint8_t buttons;
+} report;
+
+#define REPORT_EQUAL(a, b) (a.direction == b.direction && a.buttons == b.buttons)
+#define REPORT_COPY(a, b) do { a.direction = b.direction; a.buttons = b.buttons; } while (0)
+
+#define S(_pin) (1 << (_pin))
+
+// derive the pin masks, decoders and debounce windows from the config.
+// input_setup_pins() latches the GPIO mapping, which is only read at boot,
+// the decoders are always built for the latched one.
+void input_setup_pins(void);
+void input_setup_decoders(void);
+void input_setup_debounce(void);
+
+// the GPIOs of all pins
+uint32_t input_pin_mask(void);
+
+// the debounced pin states, bit n set if GPIO n is active
+uint32_t input_states(void);
+
+// starts from the given debounced pin states without any running lockout
+void input_preset(uint32_t states);
+
+// debounces a sample of the active pins (bit n set if GPIO n is low) taken at
+// time now, returns the ports with accepted edges
+uint8_t input_update(uint32_t pins, uint32_t now);
+
+// decodes the ports whose debounced pins changed since the last call into
+// decoded, returns those ports
+uint8_t input_decode_changed(report decoded[PORT_NUM]);
+
+// decodes the current state of port p
+report input_decode(uint8_t p);
+
+// the current lockout window of a pin
+uint32_t input_debounce_window(uint8_t pin);
+
+// the GPIO of a pin, as latched by input_setup_pins()
+uint8_t input_gpio(uint8_t pin);
+
+// true once the sticks have been idle for a while
+bool input_idle(uint32_t now);
+
+#endif /* INPUT_H_ */
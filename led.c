@@ -0,0 +1,157 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+
+#include "led.h"
+
+// one slot length unit is 32 state machine cycles
+#define UNIT_MS 4
+#define SLOTS 24
+
+#define PATTERN(_slot_ms, _bits) ((uint32_t)((_slot_ms) / UNIT_MS - 1) << SLOTS | (_bits))
+
+static const uint32_t patterns[LED_PATTERN_NUM] = {
+  [LED_OFF]         = PATTERN(4, 0),            // short round, so queued patterns start soon
+  [LED_NOT_MOUNTED] = PATTERN(248, 0xaaaaaa),   // toggle every 250 ms
+  [LED_SUSPENDED]   = PATTERN(624, 0xf0f0f0),   // toggle every 2.5 s
+  [LED_MOUNTED]     = PATTERN(52, 0xaaaaaa),
+  [LED_RESUMED]     = PATTERN(52, 0xaaa000),
+  [LED_FLASH]       = PATTERN(4, 0xff0000),     // 32 ms
+  [LED_ERROR_SAVE]  = PATTERN(100, 0xa80000),
+};
+
+#ifdef PICO_DEFAULT_LED_PIN
+
+#include "led_pattern.pio.h"
+
+#define SM_CLOCK_HZ (32 * 1000 / UNIT_MS)
+
+#define LED_PIO pio0
+static uint sm;
+static uint offset;
+static enum led_pattern current = LED_NOT_MOUNTED;
+
+void led_init(void) {
+  sm = pio_claim_unused_sm(LED_PIO, true);
+  offset = pio_add_program(LED_PIO, &led_pattern_program);
+
+  pio_gpio_init(LED_PIO, PICO_DEFAULT_LED_PIN);
+  pio_sm_set_consecutive_pindirs(LED_PIO, sm, PICO_DEFAULT_LED_PIN, 1, true);
+
+  pio_sm_config c = led_pattern_program_get_default_config(offset);
+  sm_config_set_out_pins(&c, PICO_DEFAULT_LED_PIN, 1);
+  sm_config_set_out_shift(&c, false, false, 32);
+  sm_config_set_clkdiv(&c, (float)clock_get_hz(clk_sys) / SM_CLOCK_HZ);
+  pio_sm_init(LED_PIO, sm, offset, &c);
+
+  led_set(current);
+}
+
+void led_set_after(const enum led_pattern once, const enum led_pattern pattern) {
+  pio_sm_set_enabled(LED_PIO, sm, false);
+  pio_sm_clear_fifos(LED_PIO, sm);
+  pio_sm_restart(LED_PIO, sm);
+  pio_sm_exec(LED_PIO, sm, pio_encode_jmp(offset));
+  pio_sm_put(LED_PIO, sm, patterns[once]);
+  if (once != pattern) pio_sm_put(LED_PIO, sm, patterns[pattern]);
+  pio_sm_set_enabled(LED_PIO, sm, true);
+  current = pattern;
+}
+
+void led_set(const enum led_pattern pattern) {
+  led_set_after(pattern, pattern);
+}
+
+void led_show(const enum led_pattern pattern) {
+  if (pio_sm_get_tx_fifo_level(LED_PIO, sm)) return;
+  pio_sm_put(LED_PIO, sm, patterns[pattern]);
+  pio_sm_put(LED_PIO, sm, patterns[current]);
+}
+
+void led_clock_changed(void) {
+  pio_sm_set_clkdiv(LED_PIO, sm, (float)clock_get_hz(clk_sys) / SM_CLOCK_HZ);
+}
+
+void led_task(void) {}
+
+#else
+
+#include "bsp/board_api.h"
+
+// No LED on a plain GPIO (e.g. Pico W, where it hangs off the wireless chip
+// and can't be driven from an interrupt). The same patterns are played by
+// led_task() from the main loop through board_led_write().
+
+static enum led_pattern current = LED_NOT_MOUNTED;  // repeated
+static enum led_pattern playing = LED_NOT_MOUNTED;  // in this round
+static enum led_pattern next = LED_PATTERN_NUM;     // for one round after this one
+static uint32_t round_start_us;
+static bool led_on;
+
+static void play(const enum led_pattern pattern) {
+  playing = pattern;
+  round_start_us = time_us_32();
+}
+
+void led_init(void) {
+  led_set(current);
+}
+
+void led_set_after(const enum led_pattern once, const enum led_pattern pattern) {
+  current = pattern;
+  next = LED_PATTERN_NUM;
+  play(once);
+}
+
+void led_set(const enum led_pattern pattern) {
+  led_set_after(pattern, pattern);
+}
+
+void led_show(const enum led_pattern pattern) {
+  if (next != LED_PATTERN_NUM || playing != current) return;
+  next = pattern;
+}
+
+void led_clock_changed(void) {}
+
+void led_task(void) {
+  const uint32_t slot_us = ((patterns[playing] >> SLOTS) + 1) * UNIT_MS * 1000;
+  uint32_t slot = (time_us_32() - round_start_us) / slot_us;
+
+  if (slot >= SLOTS) {
+    play(next != LED_PATTERN_NUM ? next : current);
+    next = LED_PATTERN_NUM;
+    slot = 0;
+  }
+  const bool on = (patterns[playing] >> (SLOTS - 1 - slot)) & 1;
+  if (on != led_on) {
+    led_on = on;
+    board_led_write(on);
+  }
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LED_H_
+#define LED_H_
+
+#include <stdint.h>
+
+// LED patterns, played by a PIO state machine (see led_pattern.pio), so the
+// CPU only posts a pattern and doesn't do any timing.
+enum led_pattern {
+  LED_OFF = 0,
+  LED_NOT_MOUNTED,
+  LED_SUSPENDED,
+  LED_MOUNTED,      // ~1 s of fast blinking
+  LED_RESUMED,      // ~0.5 s of fast blinking
+  LED_FLASH,        // short flash for a sent report
+  LED_ERROR_SAVE,   // three blinks, the config couldn't be written
+  LED_PATTERN_NUM,
+};
+
+void led_init(void);
+
+// repeats pattern from now on, replacing whatever was playing
+void led_set(enum led_pattern pattern);
+// plays one round of once, then repeats pattern
+void led_set_after(enum led_pattern once, enum led_pattern pattern);
+// plays one round of pattern, then returns to the repeated one. Dropped if
+// something else is still queued, so it is cheap enough for the report path.
+void led_show(enum led_pattern pattern);
+// re-derives the pattern timing after clk_sys changed
+void led_clock_changed(void);
+// plays the patterns on boards without the LED on a plain GPIO, call it from
+// the main loop. Does nothing otherwise.
+void led_task(void);
+
+#endif /* LED_H_ */
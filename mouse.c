@@ -0,0 +1,122 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "config.h"
+#include "governor.h"
+#include "mouse.h"
+
+// The motion is integrated by an alarm at a fixed rate, independent of the
+// main loop and the report interval. Positions are 16.16 fixed point, the
+// reports take the whole pixels and leave the fraction, so the motion doesn't
+// depend on when the reports happen to be sent. While a direction is held the
+// speed ramps up quadratically from 1/8 of mouse_speed to mouse_speed within
+// mouse_accel_ms.
+
+enum {
+  MOUSE_TICK_US = 250,
+  MOUSE_TICKS_PER_S = 1000000 / MOUSE_TICK_US,
+  MOUSE_DIAGONAL_Q16 = 46341, // 1/sqrt(2)
+  MOUSE_ACC_MAX = 127 << 16,  // unsent motion is limited to one report
+};
+
+static alarm_id_t alarm = 0;
+static volatile uint8_t direction = 0;
+static uint32_t held_ticks = 0;
+static uint32_t ramp_ticks;
+static uint32_t speed_min_q16; // pixels per tick
+static uint32_t speed_max_q16;
+static int32_t acc_x = 0, acc_y = 0;
+
+static inline uint32_t speed_q16(void) {
+  if (held_ticks >= ramp_ticks) return speed_max_q16;
+  // the ratio directly, a truncated 1 / ramp_ticks would end the ramp short
+  // of speed_max_q16 for long ramps
+  const uint32_t r = (uint32_t)(((uint64_t)held_ticks << 16) / ramp_ticks);
+  const uint32_t r2 = (uint32_t)(((uint64_t)r * r) >> 16);
+  return speed_min_q16 + (uint32_t)(((uint64_t)(speed_max_q16 - speed_min_q16) * r2) >> 16);
+}
+
+static int64_t integrate(alarm_id_t id, void *user_data) {
+  const uint8_t pins = direction;
+
+  if (!(pins & ((1 << UP) | (1 << DOWN) | (1 << LEFT) | (1 << RIGHT)))) {
+    held_ticks = 0;
+    return MOUSE_TICK_US;
+  }
+  if (held_ticks < ramp_ticks) held_ticks++;
+
+  int32_t v = speed_q16();
+  const bool vertical = pins & ((1 << UP) | (1 << DOWN));
+  const bool horizontal = pins & ((1 << LEFT) | (1 << RIGHT));
+  if (vertical && horizontal) v = (int32_t)(((int64_t)v * MOUSE_DIAGONAL_Q16) >> 16);
+
+  if (pins & (1 << LEFT)) acc_x -= v;
+  if (pins & (1 << RIGHT)) acc_x += v;
+  if (pins & (1 << UP)) acc_y -= v;
+  if (pins & (1 << DOWN)) acc_y += v;
+  acc_x = MAX(-MOUSE_ACC_MAX, MIN(acc_x, MOUSE_ACC_MAX));
+  acc_y = MAX(-MOUSE_ACC_MAX, MIN(acc_y, MOUSE_ACC_MAX));
+  // reschedule relative to this alarm's target time, so the rate doesn't drift
+  return MOUSE_TICK_US;
+}
+
+void mouse_setup(const bool enabled) {
+  const uint32_t irq = save_and_disable_interrupts();
+  speed_max_q16 = ((uint32_t)config.mouse_speed << 16) / MOUSE_TICKS_PER_S;
+  speed_min_q16 = speed_max_q16 / 8;
+  ramp_ticks = config.mouse_accel_ms * 1000 / MOUSE_TICK_US;
+  held_ticks = 0;
+  restore_interrupts(irq);
+
+  if (enabled) {
+    if (alarm <= 0) alarm = add_alarm_in_us(MOUSE_TICK_US, integrate, NULL, true);
+  } else if (alarm > 0) {
+    cancel_alarm(alarm);
+    alarm = 0;
+  }
+}
+
+void mouse_direction(const uint8_t pins) {
+  direction = pins;
+}
+
+static inline int8_t whole_pixels(int32_t *acc) {
+  // truncate towards zero, so the remainder keeps the sign of the motion
+  const int32_t px = *acc / (1 << 16);
+  *acc -= px * (1 << 16);
+  return (int8_t)px;
+}
+
+bool mouse_take(int8_t *dx, int8_t *dy) {
+  const uint32_t irq = save_and_disable_interrupts();
+  *dx = whole_pixels(&acc_x);
+  *dy = whole_pixels(&acc_y);
+  restore_interrupts(irq);
+  if (!*dx && !*dy) return false;
+  governor_boost();
+  return true;
+}
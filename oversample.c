@@ -0,0 +1,92 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+
+#include "oversample.h"
+#include "pin_sampler.pio.h"
+
+// Note: the DMA can't read the SIO GPIO input register directly, so the
+// samples are taken by a PIO state machine and drained from its RX FIFO.
+
+static volatile uint32_t ring[OVERSAMPLE_RING_SIZE] __attribute__((aligned(1 << OVERSAMPLE_RING_BITS)));
+static int dma_chan = -1;
+static uint sm;
+static uint32_t sample_rate_hz;
+
+static inline uint32_t transfer_count() {
+#ifdef DMA_CH0_TRANS_COUNT_MODE_VALUE_ENDLESS
+  return DMA_CH0_TRANS_COUNT_MODE_VALUE_ENDLESS << DMA_CH0_TRANS_COUNT_MODE_LSB;
+#else
+  return UINT32_MAX; // ~6 hours at 200 kHz, re-armed by oversample_read()
+#endif
+}
+
+void oversample_init(uint32_t rate_hz) {
+  if (dma_chan >= 0) return; // already running
+  const PIO pio = pio0;
+  sm = pio_claim_unused_sm(pio, true);
+  sample_rate_hz = rate_hz;
+  const uint offset = pio_add_program(pio, &pin_sampler_program);
+
+  pio_sm_config c = pin_sampler_program_get_default_config(offset);
+  sm_config_set_in_pins(&c, 0);
+  sm_config_set_in_shift(&c, false, true, 32);
+  sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+  sm_config_set_clkdiv(&c, (float)clock_get_hz(clk_sys) / rate_hz);
+  pio_sm_init(pio, sm, offset, &c);
+
+  // start with all pins released (high) until the ring is filled
+  for (uint32_t i = 0; i < OVERSAMPLE_RING_SIZE; i++) ring[i] = ~0u;
+
+  dma_chan = dma_claim_unused_channel(true);
+  dma_channel_config dc = dma_channel_get_default_config(dma_chan);
+  channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+  channel_config_set_read_increment(&dc, false);
+  channel_config_set_write_increment(&dc, true);
+  channel_config_set_ring(&dc, true, OVERSAMPLE_RING_BITS);
+  channel_config_set_dreq(&dc, pio_get_dreq(pio, sm, false));
+  dma_channel_configure(dma_chan, &dc, (void *)ring, &pio->rxf[sm], transfer_count(), true);
+
+  pio_sm_set_enabled(pio, sm, true);
+}
+
+void oversample_clock_changed(void) {
+  if (dma_chan < 0) return;
+  pio_sm_set_clkdiv(pio0, sm, (float)clock_get_hz(clk_sys) / sample_rate_hz);
+}
+
+uint32_t oversample_read(const uint8_t m, const uint8_t n) {
+  if (!dma_channel_is_busy(dma_chan)) {
+    dma_channel_set_trans_count(dma_chan, transfer_count(), true);
+  }
+
+  // index of the slot the DMA writes next, the newest sample is just before it
+  const uint32_t next = (dma_hw->ch[dma_chan].write_addr - (uintptr_t)ring) / sizeof(uint32_t);
+
+  return oversample_vote(ring, next, m, n);
+}
@@ -0,0 +1,74 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OVERSAMPLE_H_
+#define OVERSAMPLE_H_
+
+#include <stdint.h>
+
+// The largest vote window, limited by the 5 bit wide bit-sliced counters
+#define OVERSAMPLE_MAX_WINDOW 31
+
+// Starts sampling all GPIOs at rate_hz into a RAM ring. A PIO state machine
+// paces the samples and a DMA channel copies them, so no CPU is involved.
+// Does nothing if the sampling is already running.
+void oversample_init(uint32_t rate_hz);
+
+// Re-derives the sample rate after clk_sys changed.
+void oversample_clock_changed(void);
+
+// The ring the DMA writes the samples into
+#define OVERSAMPLE_RING_BITS 8 // ring size in bytes as power of 2
+#define OVERSAMPLE_RING_SIZE ((1 << OVERSAMPLE_RING_BITS) / sizeof(uint32_t))
+
+// Majority vote over the last m samples: returns a mask of the pins that were
+// low (active) in at least n of them.
+uint32_t oversample_read(uint8_t m, uint8_t n);
+
+// The vote of oversample_read() on a given ring, next is the index of the
+// slot after the newest sample.
+static inline uint32_t oversample_vote(const volatile uint32_t *ring, const uint32_t next,
+                                       const uint8_t m, const uint8_t n) {
+  // bit-sliced counters: bit k of count[b] is bit b of the number of samples
+  // that had GPIO k low
+  uint32_t count[5] = { 0 };
+  for (uint8_t i = 1; i <= m; i++) {
+    uint32_t carry = ~ring[(next - i) % OVERSAMPLE_RING_SIZE];
+    for (uint8_t b = 0; b < 5; b++) {
+      const uint32_t t = count[b] & carry;
+      count[b] ^= carry;
+      carry = t;
+    }
+  }
+
+  // count >= n if count - n doesn't borrow
+  uint32_t borrow = 0;
+  for (uint8_t b = 0; b < 5; b++) {
+    const uint32_t nb = (n & (1 << b)) ? ~0u : 0;
+    borrow = (~count[b] & (nb | borrow)) | (nb & borrow);
+  }
+  return ~borrow;
+}
+
+#endif /* OVERSAMPLE_H_ */
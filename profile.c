@@ -0,0 +1,101 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+#include "profile.h"
+
+#if DUALJOY_PROFILE
+
+#if defined(__ARM_ARCH_6M__)
+#include "hardware/structs/systick.h"
+#elif defined(__ARM_ARCH_8M_MAIN__)
+#include "hardware/structs/m33.h"
+#endif
+
+dj_profile profile;
+
+void profile_init(void) {
+#if defined(__ARM_ARCH_6M__)
+  systick_hw->csr = 0;
+  systick_hw->rvr = 0xffffff;
+  systick_hw->cvr = 0;
+  systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS; // processor clock
+#elif defined(__ARM_ARCH_8M_MAIN__)
+  m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+  m33_hw->dwt_cyccnt = 0;
+  m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#elif defined(__riscv)
+  __asm volatile ("csrw mcountinhibit, zero");
+#endif
+  memset(&profile, 0, sizeof(profile));
+  for (uint8_t i = 0; i < DJ_PROFILE_SLOTS; i++) {
+    profile.slots[i].min = UINT32_MAX;
+  }
+  profile.cpu_hz = clock_get_hz(clk_sys);
+}
+
+void profile_clock_changed(void) {
+  profile.cpu_hz = clock_get_hz(clk_sys);
+}
+
+uint32_t __not_in_flash_func(profile_cycles)(void) {
+#if defined(__ARM_ARCH_6M__)
+  return systick_hw->cvr;
+#elif defined(__ARM_ARCH_8M_MAIN__)
+  return m33_hw->dwt_cyccnt;
+#elif defined(__riscv)
+  uint32_t c;
+  __asm volatile ("csrr %0, mcycle" : "=r" (c));
+  return c;
+#else
+#error "no cycle counter for this architecture"
+#endif
+}
+
+void __not_in_flash_func(profile_record)(const uint8_t slot, const uint32_t cycles) {
+  dj_profile_slot *s = &profile.slots[slot];
+
+  s->count++;
+  if (cycles < s->min) s->min = cycles;
+  if (cycles > s->max) s->max = cycles;
+  const uint32_t lo = s->total_lo + cycles;
+  if (lo < s->total_lo) s->total_hi++;
+  s->total_lo = lo;
+
+  // keep the largest samples, sorted descending
+  if (cycles <= s->outliers[DJ_PROFILE_OUTLIERS - 1]) return;
+  uint8_t i = DJ_PROFILE_OUTLIERS - 1;
+  for (; i > 0 && cycles > s->outliers[i - 1]; i--) {
+    s->outliers[i] = s->outliers[i - 1];
+    s->outlier_us[i] = s->outlier_us[i - 1];
+  }
+  s->outliers[i] = cycles;
+  s->outlier_us[i] = time_us_32();
+}
+
+#endif
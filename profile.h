@@ -0,0 +1,66 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+// Cycle accurate profiling of the hot path, only compiled into the
+// dualjoy_profile build (DUALJOY_PROFILE=1). Uses the 24 bit SysTick counter
+// on the Cortex-M0+ (RP2040) and the DWT cycle counter on the Cortex-M33
+// (RP2350). The slots are defined in dualjoy_protocol.h.
+
+#include <stdint.h>
+
+#include "dualjoy_protocol.h"
+
+#if DUALJOY_PROFILE
+
+extern dj_profile profile;
+
+void profile_init(void);
+void profile_record(uint8_t slot, uint32_t cycles);
+uint32_t profile_cycles(void);
+// keeps cpu_hz at the current clk_sys, call after it changed
+void profile_clock_changed(void);
+
+#define PROFILE_BEGIN(_slot) const uint32_t _profile_start_##_slot = profile_cycles()
+#define PROFILE_END(_slot) profile_record(_slot, profile_elapsed(_profile_start_##_slot))
+
+#if defined(__ARM_ARCH_6M__)
+// SysTick counts down and wraps at 24 bit
+#define profile_elapsed(_start) (((_start) - profile_cycles()) & 0xffffff)
+#else
+#define profile_elapsed(_start) (profile_cycles() - (_start))
+#endif
+
+#else
+
+#define profile_init() do {} while (0)
+#define profile_clock_changed() do {} while (0)
+#define PROFILE_BEGIN(_slot) do {} while (0)
+#define PROFILE_END(_slot) do {} while (0)
+
+#endif
+
+#endif /* PROFILE_H_ */
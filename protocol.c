@@ -0,0 +1,204 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "dualjoy.h"
+#include "dualjoy_protocol.h"
+#include "config.h"
+#include "protocol.h"
+#include "profile.h"
+
+// where the params live in dualjoy_config
+typedef struct {
+  uint16_t offset;
+  uint8_t size;   // of one element
+  uint8_t count;
+} param_field;
+
+#define DJ_PARAM_FIELD(_id, _name, _count, _field) \
+  [_id] = { offsetof(dualjoy_config, _field), sizeof(config._field) / (_count), _count },
+static const param_field fields[DJ_PARAM_NUM] = {
+  DJ_PARAMS(DJ_PARAM_FIELD)
+};
+#undef DJ_PARAM_FIELD
+
+#define DJ_PARAM_COUNT(_id, _name, _count, _field) \
+  _Static_assert((_count == 1 || _count == PORT_NUM || _count == TOTAL_PIN_NUM) && \
+                 sizeof(config._field) % (_count) == 0, #_id);
+DJ_PARAMS(DJ_PARAM_COUNT)
+#undef DJ_PARAM_COUNT
+
+static uint8_t get_param(const dj_feature *req, dj_feature *resp) {
+  const param_field *f = &fields[req->id];
+  uint8_t *p = (uint8_t *)&config + f->offset + req->index * f->size;
+
+  if (req->id == DJ_PARAM_DEBOUNCE_WINDOW) {
+    resp->value = dualjoy_debounce_window(req->index);
+    return DJ_OK;
+  }
+
+  resp->value = 0;
+  memcpy(&resp->value, p, f->size);
+  return DJ_OK;
+}
+
+static uint8_t set_param(const dj_feature *req) {
+  const param_field *f = &fields[req->id];
+
+  if (req->id == DJ_PARAM_DEBOUNCE_WINDOW) return DJ_ERR_READONLY;
+  if (f->size < sizeof(req->value) && (req->value >> (8 * f->size))) return DJ_ERR_VALUE;
+
+  // validate the changed config as a whole before it gets applied
+  static dualjoy_config tmp;
+  memcpy(&tmp, &config, sizeof(tmp));
+  memcpy((uint8_t *)&tmp + f->offset + req->index * f->size, &req->value, f->size);
+  if (!config_valid(&tmp)) return DJ_ERR_VALUE;
+
+  memcpy(&config, &tmp, sizeof(config));
+  dualjoy_config_changed(req->id);
+  return DJ_OK;
+}
+
+static uint8_t read_block(const dj_feature *req, dj_feature *resp) {
+  const uint32_t *words;
+  size_t size;
+
+  switch (req->id) {
+    case DJ_BLOCK_COUNTERS:
+      words = (const uint32_t *)&counters;
+      size = sizeof(counters) / sizeof(uint32_t);
+      break;
+    case DJ_BLOCK_HISTOGRAMS:
+      words = (const uint32_t *)&histograms;
+      size = sizeof(histograms) / sizeof(uint32_t);
+      break;
+    case DJ_BLOCK_BOOT:
+      words = (const uint32_t *)&boot;
+      size = sizeof(boot) / sizeof(uint32_t);
+      break;
+    case DJ_BLOCK_TRACE:
+      // a dump starts at 0, keep the ring still until it is reset
+      if (req->value == 0) input_trace.frozen = true;
+      words = (const uint32_t *)&input_trace;
+      size = sizeof(input_trace) / sizeof(uint32_t);
+      break;
+#if DUALJOY_PROFILE
+    case DJ_BLOCK_PROFILE:
+      words = (const uint32_t *)&profile;
+      size = sizeof(profile) / sizeof(uint32_t);
+      break;
+#endif
+    default:
+      return DJ_ERR_ID;
+  }
+
+  if (req->value > size) return DJ_ERR_INDEX;
+  resp->value = req->value;
+  resp->count = (size - req->value < DJ_BLOCK_WORDS) ? size - req->value : DJ_BLOCK_WORDS;
+  memcpy(resp->data, &words[req->value], resp->count * sizeof(uint32_t));
+  return DJ_OK;
+}
+
+static uint8_t reset_block(const dj_feature *req) {
+  switch (req->id) {
+    case DJ_BLOCK_COUNTERS:
+      memset(&counters, 0, sizeof(counters));
+      return DJ_OK;
+    case DJ_BLOCK_HISTOGRAMS:
+      memset(&histograms, 0, sizeof(histograms));
+      return DJ_OK;
+    case DJ_BLOCK_TRACE:
+      dualjoy_reset_trace();
+      return DJ_OK;
+#if DUALJOY_PROFILE
+    case DJ_BLOCK_PROFILE:
+      profile_init();
+      return DJ_OK;
+#endif
+    default:
+      return DJ_ERR_ID;
+  }
+}
+
+static dj_feature feature_answer;
+
+void protocol_handle(const dj_feature *req, dj_feature *resp) {
+  memset(resp, 0, sizeof(*resp));
+  resp->cmd = req->cmd;
+  resp->id = req->id;
+  resp->index = req->index;
+  resp->seq = req->seq;
+
+  switch (req->cmd) {
+    case DJ_CMD_NOP:
+      resp->status = DJ_OK;
+      break;
+    case DJ_CMD_GET:
+    case DJ_CMD_SET:
+      if (req->id >= DJ_PARAM_NUM) {
+        resp->status = DJ_ERR_ID;
+      } else if (req->index >= fields[req->id].count) {
+        resp->status = DJ_ERR_INDEX;
+      } else if (req->cmd == DJ_CMD_SET) {
+        resp->status = set_param(req);
+        if (resp->status == DJ_OK) get_param(req, resp);
+      } else {
+        resp->status = get_param(req, resp);
+      }
+      break;
+    case DJ_CMD_SAVE:
+      dualjoy_request_save();
+      resp->status = DJ_OK;
+      break;
+    case DJ_CMD_DEFAULTS:
+      config_set_defaults(&config);
+      dualjoy_config_changed(DJ_PARAM_NUM);
+      resp->status = DJ_OK;
+      break;
+    case DJ_CMD_READ:
+      resp->status = read_block(req, resp);
+      break;
+    case DJ_CMD_RESET:
+      resp->status = reset_block(req);
+      break;
+    default:
+      resp->status = DJ_ERR_CMD;
+      break;
+  }
+}
+
+void protocol_set_report(const uint8_t *buffer, const uint16_t bufsize) {
+  // short requests are padded with zeroes
+  dj_feature req = { 0 };
+  memcpy(&req, buffer, bufsize < sizeof(req) ? bufsize : sizeof(req));
+  protocol_handle(&req, &feature_answer);
+}
+
+uint16_t protocol_get_report(uint8_t *buffer, const uint16_t reqlen) {
+  if (reqlen < sizeof(feature_answer)) return 0;
+  memcpy(buffer, &feature_answer, sizeof(feature_answer));
+  return sizeof(feature_answer);
+}
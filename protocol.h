@@ -0,0 +1,58 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <stdint.h>
+
+#include "dualjoy_protocol.h"
+
+extern dj_counters counters;
+extern dj_histograms histograms;
+extern dj_boot boot;
+extern dj_trace input_trace;
+
+// handles a request of the feature report protocol, never blocks
+void protocol_handle(const dj_feature *req, dj_feature *resp);
+
+// the feature report as the HID callbacks see it: SET_REPORT handles a
+// request, GET_REPORT returns its answer. protocol_get_report() returns the
+// length, or 0 if buffer is too short.
+void protocol_set_report(const uint8_t *buffer, uint16_t bufsize);
+uint16_t protocol_get_report(uint8_t *buffer, uint16_t reqlen);
+
+// implemented in dualjoy.c
+
+// re-derive the runtime state after a config param changed, DJ_PARAM_NUM
+// for all params
+void dualjoy_config_changed(uint8_t param);
+// persist the config once the sticks are idle
+void dualjoy_request_save(void);
+// the current lockout window of a pin
+uint32_t dualjoy_debounce_window(uint8_t pin);
+// restart the recording of DJ_BLOCK_TRACE
+void dualjoy_reset_trace(void);
+
+#endif /* PROTOCOL_H_ */
@@ -0,0 +1,248 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "reports.h"
+#include "config.h"
+#include "xinput.h"
+#include "mouse.h"
+
+// Every mode has a report builder, picked once by reports_select(). Most
+// modes encode a report per instance, the generic send_encoded() sends it if
+// its bytes changed. The mouse has its own routine, since its motion comes
+// from the integrator and not from the port states.
+
+typedef uint8_t report_encoder(uint8_t instance, const report r[PORT_NUM], uint8_t *buf);
+
+typedef struct {
+  uint8_t id;                       // report ID, 0 for XInput
+  uint8_t ports;                    // covered by the reports
+  uint8_t len;                      // of the built report
+  uint8_t built[REPORTS_MAX_LEN];   // last built report, served to GET_REPORT
+  uint8_t sent[REPORTS_MAX_LEN];    // last queued report
+} report_instance;
+
+static report_instance instances[PORT_NUM];
+static uint8_t instance_num;
+static report_encoder *encode;
+static void (*send)(const report r[PORT_NUM]);
+static uint8_t resend_ports; // ports whose state must be sent, even if it didn't change
+
+static const uint8_t report_ids[PORT_NUM] = { JOYSTICK_REPORT_ID, JOYSTICK2_REPORT_ID };
+
+// the pins of a decoded direction
+static const uint8_t hat_pins[9] = {
+  S(UP), S(UP) | S(RIGHT), S(RIGHT), S(DOWN) | S(RIGHT),
+  S(DOWN), S(DOWN) | S(LEFT), S(LEFT), S(UP) | S(LEFT),
+  0,
+};
+
+// one HID gamepad per port, the report is the port state
+static uint8_t encode_gamepad(const uint8_t instance, const report r[PORT_NUM], uint8_t *buf) {
+  buf[0] = r[instance].direction;
+  buf[1] = r[instance].buttons;
+  return sizeof(report);
+}
+
+// NKRO keyboard report, both ports share it
+typedef struct {
+  uint8_t modifiers;
+  uint8_t keys[KEYBOARD_KEY_NUM / 8];
+} keyboard_report;
+
+static inline void keyboard_press(keyboard_report *r, const uint8_t key) {
+  if (key >= KEYBOARD_MODIFIER_FIRST) {
+    r->modifiers |= 1 << (key - KEYBOARD_MODIFIER_FIRST);
+  } else if (key) {
+    r->keys[key / 8] |= 1 << (key % 8);
+  }
+}
+
+static uint8_t encode_keyboard(const uint8_t instance, const report r[PORT_NUM], uint8_t *buf) {
+  (void) instance; // a single instance
+  keyboard_report k = { 0 };
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    const uint8_t pins = hat_pins[r[p].direction] | (r[p].buttons ? S(BTN) : 0);
+    for (uint8_t i = 0; i < PIN_NUM; i++) {
+      if (pins & S(i)) keyboard_press(&k, config.keys[p * PIN_NUM + i]);
+    }
+  }
+  memcpy(buf, &k, sizeof(k));
+  return sizeof(k);
+}
+
+static uint8_t encode_xinput(const uint8_t instance, const report r[PORT_NUM], uint8_t *buf) {
+  // the pin bits of a direction match the XInput D-pad bits
+  const uint8_t b = r[instance].buttons;
+  const xinput_report x = {
+    .len = sizeof(xinput_report),
+    .buttons = hat_pins[r[instance].direction] | ((b & 1) ? XINPUT_A : 0) |
+               ((b & 2) ? XINPUT_B : 0) | ((b & 4) ? XINPUT_X : 0),
+  };
+  memcpy(buf, &x, sizeof(x));
+  return sizeof(x);
+}
+
+// combined gamepad report, a hat per port and a button bit per port
+typedef struct {
+  uint8_t hats[PORT_NUM];
+  uint8_t buttons;
+} combined_report;
+
+static uint8_t encode_combined(const uint8_t instance, const report r[PORT_NUM], uint8_t *buf) {
+  (void) instance; // a single instance
+  combined_report c = { 0 };
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    c.hats[p] = r[p].direction;
+    if (r[p].buttons) c.buttons |= 1 << p;
+  }
+  memcpy(buf, &c, sizeof(c));
+  return sizeof(c);
+}
+
+_Static_assert(sizeof(keyboard_report) <= REPORTS_MAX_LEN, "report too long");
+_Static_assert(sizeof(xinput_report) <= REPORTS_MAX_LEN, "report too long");
+
+static void send_encoded(const report r[PORT_NUM]) {
+  for (uint8_t i = 0; i < instance_num; i++) {
+    report_instance *in = &instances[i];
+
+    in->len = encode(i, r, in->built);
+    if (!memcmp(in->built, in->sent, in->len) && !(resend_ports & in->ports)) {
+      report_unchanged(in->ports);
+      continue;
+    }
+    // the host didn't pick up the last one yet, the next loop tries again
+    if (!report_ready(i)) continue;
+    if (report_transmit(i, in->id, in->built, in->len)) {
+      memcpy(in->sent, in->built, in->len);
+      resend_ports &= ~in->ports;
+      report_queued(in->ports);
+    } else {
+      report_failed();
+    }
+  }
+}
+
+enum {
+  MOUSE_LEFT = 1 << 0,
+  MOUSE_RIGHT = 1 << 1,
+};
+
+// the boot protocol layout of TUD_HID_REPORT_DESC_MOUSE
+typedef struct {
+  uint8_t buttons;
+  int8_t x, y, wheel, pan;
+} mouse_report;
+
+static void send_mouse(const report r[PORT_NUM]) {
+  report_instance *in = &instances[0];
+  const uint8_t p = config.mouse_port;
+  const uint8_t other = (p + 1) % PORT_NUM;
+  const uint8_t buttons = (r[p].buttons ? MOUSE_LEFT : 0) | (r[other].buttons ? MOUSE_RIGHT : 0);
+
+  // the motion only exists in the input reports
+  const mouse_report idle = { .buttons = buttons };
+  memcpy(in->built, &idle, sizeof(idle));
+  in->len = sizeof(idle);
+
+  mouse_direction(hat_pins[r[p].direction]);
+  // keep the motion in the integrator until it can be sent
+  if (!report_ready(0)) return;
+
+  mouse_report m = idle;
+  if (!mouse_take(&m.x, &m.y) && buttons == in->sent[0] && !(resend_ports & in->ports)) {
+    report_unchanged(in->ports);
+    return;
+  }
+  if (report_transmit(0, in->id, &m, sizeof(m))) {
+    in->sent[0] = buttons;
+    resend_ports &= ~in->ports;
+    report_queued(in->ports);
+  } else {
+    report_failed();
+  }
+}
+
+void reports_select(const uint8_t mode) {
+  const uint8_t all_ports = (1 << PORT_NUM) - 1;
+
+  memset(instances, 0, sizeof(instances));
+  send = send_encoded;
+  switch (mode) {
+    case USB_MODE_KEYBOARD:
+      encode = encode_keyboard;
+      instance_num = 1;
+      instances[0].id = KEYBOARD_REPORT_ID;
+      instances[0].ports = all_ports;
+      break;
+    case USB_MODE_XINPUT:
+      encode = encode_xinput;
+      instance_num = PORT_NUM;
+      for (uint8_t p = 0; p < PORT_NUM; p++) instances[p].ports = 1 << p;
+      break;
+    case USB_MODE_MOUSE:
+      send = send_mouse;
+      instance_num = 1;
+      instances[0].id = MOUSE_REPORT_ID;
+      instances[0].ports = all_ports;
+      break;
+    case USB_MODE_COMBINED:
+      encode = encode_combined;
+      instance_num = 1;
+      instances[0].id = COMBINED_REPORT_ID;
+      instances[0].ports = all_ports;
+      break;
+    default:
+      encode = encode_gamepad;
+      instance_num = PORT_NUM;
+      for (uint8_t p = 0; p < PORT_NUM; p++) {
+        instances[p].id = report_ids[p];
+        instances[p].ports = 1 << p;
+      }
+      break;
+  }
+}
+
+void reports_send(const report r[PORT_NUM]) {
+  send(r);
+}
+
+void reports_resend(void) {
+  resend_ports = (1 << PORT_NUM) - 1;
+}
+
+uint8_t reports_ports(const uint8_t instance) {
+  return instance < instance_num ? instances[instance].ports : 0;
+}
+
+uint16_t reports_get(const uint8_t instance, const uint8_t report_id, uint8_t *buf, const uint16_t len) {
+  if (instance >= instance_num) return 0;
+
+  const report_instance *in = &instances[instance];
+  if (!in->id || report_id != in->id || !in->len || len < in->len) return 0;
+  memcpy(buf, in->built, in->len);
+  return in->len;
+}
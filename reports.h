@@ -0,0 +1,75 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef REPORTS_H_
+#define REPORTS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dualjoy.h"
+#include "input.h"
+
+// Builds the reports of the USB modes from the port states and decides which
+// of them have to be sent. Like the input pipeline it only depends on the
+// config, the transport is left to the platform hooks below.
+
+enum {
+  REPORTS_MAX_LEN = 20, // the XInput report
+};
+
+// picks the report builder of mode, call once the host selected a
+// configuration, so building a report never branches on the mode
+void reports_select(uint8_t mode);
+
+// builds the reports from the port states and sends those that changed or
+// cover a port marked for a resend
+void reports_send(const report r[PORT_NUM]);
+
+// sends the next reports even if they didn't change, e.g. after the mount
+void reports_resend(void);
+
+// the ports covered by the reports of an instance (HID or XInput interface)
+uint8_t reports_ports(uint8_t instance);
+
+// copies the last built input report of an instance for GET_REPORT, returns
+// its length or 0 if the instance has no such report
+uint16_t reports_get(uint8_t instance, uint8_t report_id, uint8_t *buf, uint16_t len);
+
+// implemented by the platform, dualjoy.c on the device and the replay tool
+// on the host
+
+// queues a report on an instance, report_id 0 is an XInput report. Returns
+// false if the instance is busy.
+bool report_transmit(uint8_t instance, uint8_t report_id, const void *report, uint16_t len);
+// true if the instance can take a report right away
+bool report_ready(uint8_t instance);
+// a report covering ports was queued
+void report_queued(uint8_t ports);
+// the state of ports didn't change their reports
+void report_unchanged(uint8_t ports);
+// report_transmit() failed
+void report_failed(void);
+
+#endif /* REPORTS_H_ */
@@ -0,0 +1,419 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Command line tool for the DualJoy configuration protocol on Linux, talks to
+// the device through the hidraw driver.
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/hidraw.h>
+
+#include "dualjoy_protocol.h"
+
+#define USB_VID 0xCAFE
+
+typedef struct {
+  const char *name;
+  uint8_t count;
+} param_info;
+
+#define DJ_PARAM_INFO(_id, _name, _count, _field) [_id] = { _name, _count },
+static const param_info params[DJ_PARAM_NUM] = {
+  DJ_PARAMS(DJ_PARAM_INFO)
+};
+#undef DJ_PARAM_INFO
+
+typedef struct {
+  const char *name;
+  size_t offset;
+  uint8_t count;
+  bool max;       // a maximum, not a counter
+} counter_info;
+
+#define COUNTER(_f, _max) { #_f, offsetof(dj_counters, _f), sizeof(((dj_counters *)0)->_f) / sizeof(uint32_t), _max }
+static const counter_info counter_infos[] = {
+  COUNTER(loops, false),
+  COUNTER(loop_time_us, false),
+  COUNTER(loop_time_max_us, true),
+  COUNTER(samples, false),
+  COUNTER(edges, false),
+  COUNTER(rejections, false),
+  COUNTER(reports, false),
+  COUNTER(report_failures, false),
+  COUNTER(edge_latency_max_us, true),
+};
+
+static const char *status_names[] = {
+  [DJ_OK] = "ok",
+  [DJ_ERR_CMD] = "unknown command",
+  [DJ_ERR_ID] = "unknown param or block",
+  [DJ_ERR_INDEX] = "index out of range",
+  [DJ_ERR_VALUE] = "invalid value",
+  [DJ_ERR_READONLY] = "read only",
+};
+
+static int fd = -1;
+static uint8_t seq = 0;
+
+static int transact(dj_feature *req, dj_feature *resp) {
+  uint8_t buf[1 + sizeof(dj_feature)];
+
+  req->seq = ++seq;
+  buf[0] = DJ_FEATURE_REPORT_ID;
+  memcpy(&buf[1], req, sizeof(*req));
+  if (ioctl(fd, HIDIOCSFEATURE(sizeof(buf)), buf) < 0) {
+    perror("HIDIOCSFEATURE");
+    return -1;
+  }
+
+  buf[0] = DJ_FEATURE_REPORT_ID;
+  const int n = ioctl(fd, HIDIOCGFEATURE(sizeof(buf)), buf);
+  if (n < (int)sizeof(buf)) {
+    perror("HIDIOCGFEATURE");
+    return -1;
+  }
+  memcpy(resp, &buf[1], sizeof(*resp));
+
+  if (resp->seq != req->seq || resp->cmd != req->cmd) {
+    fprintf(stderr, "unexpected answer\n");
+    return -1;
+  }
+  if (resp->status != DJ_OK) {
+    fprintf(stderr, "error: %s\n", resp->status < sizeof(status_names) / sizeof(status_names[0])
+            ? status_names[resp->status] : "unknown");
+    return -1;
+  }
+  return 0;
+}
+
+static int command(uint8_t cmd, uint8_t id, uint8_t index, uint32_t value, dj_feature *resp) {
+  dj_feature req = { .cmd = cmd, .id = id, .index = index, .value = value };
+  return transact(&req, resp);
+}
+
+// reads a whole block of n words
+static int read_block(uint8_t id, uint32_t *words, size_t n) {
+  for (size_t i = 0; i < n; i += DJ_BLOCK_WORDS) {
+    dj_feature resp;
+    if (command(DJ_CMD_READ, id, 0, i, &resp) < 0) return -1;
+    memcpy(&words[i], resp.data, resp.count * sizeof(uint32_t));
+    if (resp.count < DJ_BLOCK_WORDS) break;
+  }
+  return 0;
+}
+
+static int read_counters(dj_counters *c) {
+  return read_block(DJ_BLOCK_COUNTERS, (uint32_t *)c, sizeof(*c) / sizeof(uint32_t));
+}
+
+// prints all counters, or the difference to prev for everything but maxima
+static void print_counters(const dj_counters *c, const dj_counters *prev) {
+  for (size_t i = 0; i < sizeof(counter_infos) / sizeof(counter_infos[0]); i++) {
+    const counter_info *info = &counter_infos[i];
+    const uint32_t *v = (const uint32_t *)((const uint8_t *)c + info->offset);
+    const uint32_t *p = (const uint32_t *)((const uint8_t *)prev + info->offset);
+
+    printf("%-20s", info->name);
+    for (uint8_t j = 0; j < info->count; j++) {
+      printf(" %10u", (prev && !info->max) ? v[j] - p[j] : v[j]);
+    }
+    printf("\n");
+  }
+  const uint32_t loops = prev ? c->loops - prev->loops : c->loops;
+  const uint32_t time = prev ? c->loop_time_us - prev->loop_time_us : c->loop_time_us;
+  printf("%-20s %10.1f\n", "loop_time_avg_us", loops ? (double)time / loops : 0.0);
+}
+
+static void print_histogram(const char *title, const uint32_t buckets[PORT_NUM][DJ_HIST_BUCKETS]) {
+  printf("%s\n%-16s", title, "latency us");
+  for (uint8_t p = 0; p < PORT_NUM; p++) printf("   port %u", p + 1);
+  printf("\n");
+  for (uint8_t b = 0; b < DJ_HIST_BUCKETS; b++) {
+    char range[32];
+    if (b == 0) snprintf(range, sizeof(range), "< 2");
+    else if (b == DJ_HIST_BUCKETS - 1) snprintf(range, sizeof(range), ">= %u", 1u << b);
+    else snprintf(range, sizeof(range), "%u - %u", 1u << b, (2u << b) - 1);
+    printf("%-16s", range);
+    for (uint8_t p = 0; p < PORT_NUM; p++) printf(" %8u", buckets[p][b]);
+    printf("\n");
+  }
+}
+
+static void print_profile(const dj_profile *prof) {
+  static const char *const names[DJ_PROFILE_SLOTS] = {
+    [DJ_PROFILE_UPDATE_STATES] = "update_states_task",
+    [DJ_PROFILE_SEND_STATES] = "send_states",
+  };
+  const double mhz = prof->cpu_hz / 1e6;
+
+  printf("cycles at %.1f MHz\n", mhz);
+  printf("%-20s %10s %8s %8s %10s %10s\n", "", "calls", "min", "max", "mean", "max us");
+  for (uint8_t i = 0; i < DJ_PROFILE_SLOTS; i++) {
+    const dj_profile_slot *s = &prof->slots[i];
+    const uint64_t total = (uint64_t)s->total_hi << 32 | s->total_lo;
+    printf("%-20s %10u %8u %8u %10.1f %10.1f\n", names[i], s->count,
+           s->count ? s->min : 0, s->max, s->count ? (double)total / s->count : 0.0,
+           mhz > 0 ? s->max / mhz : 0.0);
+  }
+  printf("\nworst samples (cycles @ time_us):\n");
+  for (uint8_t i = 0; i < DJ_PROFILE_SLOTS; i++) {
+    printf("%-20s", names[i]);
+    for (uint8_t j = 0; j < DJ_PROFILE_OUTLIERS && prof->slots[i].outliers[j]; j++) {
+      printf(" %u@%u", prof->slots[i].outliers[j], prof->slots[i].outlier_us[j]);
+    }
+    printf("\n");
+  }
+}
+
+static void print_boot(const dj_boot *b) {
+  static const char *const names[DJ_BOOT_PHASES] = {
+    [DJ_BOOT_BOARD] = "board",
+    [DJ_BOOT_CONFIG] = "config",
+    [DJ_BOOT_GPIOS] = "gpios",
+    [DJ_BOOT_USB] = "usb",
+    [DJ_BOOT_MOUNTED] = "mounted",
+    [DJ_BOOT_FIRST_REPORT] = "first_report",
+  };
+  uint32_t prev = 0;
+
+  printf("%-14s %10s %10s\n", "phase", "done us", "took us");
+  for (uint8_t i = 0; i < DJ_BOOT_PHASES; i++) {
+    if (!b->done_us[i]) {
+      printf("%-14s %10s\n", names[i], "-");
+      continue;
+    }
+    printf("%-14s %10u %10u\n", names[i], b->done_us[i], b->done_us[i] - prev);
+    prev = b->done_us[i];
+  }
+}
+
+static int open_device(const char *path) {
+  if (path) return open(path, O_RDWR);
+
+  DIR *dir = opendir("/dev");
+  if (!dir) return -1;
+
+  struct dirent *e;
+  int found = -1;
+  while (found < 0 && (e = readdir(dir))) {
+    if (strncmp(e->d_name, "hidraw", 6)) continue;
+
+    char dev[300];
+    snprintf(dev, sizeof(dev), "/dev/%s", e->d_name);
+    const int f = open(dev, O_RDWR);
+    if (f < 0) continue;
+
+    // the feature report is only on the first interface, so probe with a NOP
+    struct hidraw_devinfo info;
+    dj_feature resp;
+    fd = f;
+    if (ioctl(f, HIDIOCGRAWINFO, &info) == 0 && (uint16_t)info.vendor == USB_VID &&
+        command(DJ_CMD_NOP, 0, 0, 0, &resp) == 0) {
+      found = f;
+    } else {
+      close(f);
+    }
+  }
+  closedir(dir);
+  return found;
+}
+
+static int find_param(const char *name) {
+  for (int i = 0; i < DJ_PARAM_NUM; i++) {
+    if (!strcmp(params[i].name, name)) return i;
+  }
+  fprintf(stderr, "unknown param %s\n", name);
+  return -1;
+}
+
+static int print_param(int id) {
+  printf("%-18s", params[id].name);
+  for (uint8_t i = 0; i < params[id].count; i++) {
+    dj_feature resp;
+    if (command(DJ_CMD_GET, id, i, 0, &resp) < 0) return -1;
+    printf(" %u", resp.value);
+  }
+  printf("\n");
+  return 0;
+}
+
+static void print_values(int id, const uint32_t *values) {
+  printf("%-18s", params[id].name);
+  for (uint8_t i = 0; i < params[id].count; i++) printf(" %u", values[i]);
+  printf("\n");
+}
+
+// prints the params and the recorded samples in the format of dualjoyreplay
+static int print_trace(void) {
+  static dj_trace t;
+  const size_t header = offsetof(dj_trace, entries) / sizeof(uint32_t);
+
+  // the first read freezes the ring, so the header and the samples match
+  if (read_block(DJ_BLOCK_TRACE, (uint32_t *)&t, header) < 0) return -1;
+  const uint32_t n = t.count < DJ_TRACE_LEN ? t.count : DJ_TRACE_LEN;
+  if (read_block(DJ_BLOCK_TRACE, (uint32_t *)&t, header + n * sizeof(dj_trace_entry) / sizeof(uint32_t)) < 0) return -1;
+
+  // the windows and GPIOs in force when the ring restarted, not the current ones
+  uint32_t gpios[TOTAL_PIN_NUM];
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) gpios[i] = t.gpios[i];
+
+  printf("# dualjoy trace\n");
+  for (int i = 0; i < DJ_PARAM_NUM; i++) {
+    if (i == DJ_PARAM_GPIO) print_values(i, gpios);
+    else if (i == DJ_PARAM_DEBOUNCE_WINDOW) print_values(i, t.windows_us);
+    else if (print_param(i) < 0) return -1;
+  }
+
+  // the oldest entry first
+  const uint32_t first = t.count < DJ_TRACE_LEN ? 0 : t.count % DJ_TRACE_LEN;
+  printf("# sample time_us pins states\n");
+  for (uint32_t i = 0; i < n; i++) {
+    const dj_trace_entry *e = &t.entries[(first + i) % DJ_TRACE_LEN];
+    printf("sample %u 0x%08x 0x%08x\n", e->time_us, e->pins, e->states);
+  }
+  return 0;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+    "usage: dualjoyctl [-d /dev/hidrawN] <command>\n"
+    "commands:\n"
+    "  list                         show all params\n"
+    "  get <param> [index]          show a param\n"
+    "  set <param> [index] <value>  change a param (applied immediately, some after a reboot)\n"
+    "  save                         store the config in flash\n"
+    "  defaults                     restore the default config (not saved)\n"
+    "  counters                     show the counters\n"
+    "  monitor [interval_ms]        poll the counters and show the differences\n"
+    "  reset-counters               reset the counters\n"
+    "  histograms                   show the edge to report latency histograms\n"
+    "  reset-histograms             reset the histograms\n"
+    "  boot                         show the duration of the boot phases\n"
+    "  trace                        dump the recorded samples for dualjoyreplay (pauses the recording)\n"
+    "  reset-trace                  restart the recording\n"
+    "  profile                      show the cycle counts (dualjoy_profile build only)\n"
+    "  reset-profile                reset the cycle counts\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *path = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:h")) != -1) {
+    if (opt == 'd') path = optarg;
+    else usage();
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc < 1) usage();
+
+  fd = open_device(path);
+  if (fd < 0) {
+    fprintf(stderr, "no DualJoy found%s\n", errno == EACCES ? " (permission denied)" : "");
+    return 1;
+  }
+
+  const char *cmd = argv[0];
+  dj_feature resp;
+  int ret = 0;
+
+  if (!strcmp(cmd, "list")) {
+    for (int i = 0; i < DJ_PARAM_NUM && ret == 0; i++) ret = print_param(i);
+  } else if (!strcmp(cmd, "get") && argc >= 2) {
+    const int id = find_param(argv[1]);
+    if (id < 0) return 1;
+    if (argc == 3) {
+      ret = command(DJ_CMD_GET, id, strtoul(argv[2], NULL, 0), 0, &resp);
+      if (ret == 0) printf("%u\n", resp.value);
+    } else {
+      ret = print_param(id);
+    }
+  } else if (!strcmp(cmd, "set") && (argc == 3 || argc == 4)) {
+    const int id = find_param(argv[1]);
+    if (id < 0) return 1;
+    const uint8_t index = argc == 4 ? strtoul(argv[2], NULL, 0) : 0;
+    ret = command(DJ_CMD_SET, id, index, strtoul(argv[argc - 1], NULL, 0), &resp);
+  } else if (!strcmp(cmd, "save")) {
+    ret = command(DJ_CMD_SAVE, 0, 0, 0, &resp);
+  } else if (!strcmp(cmd, "defaults")) {
+    ret = command(DJ_CMD_DEFAULTS, 0, 0, 0, &resp);
+  } else if (!strcmp(cmd, "counters")) {
+    dj_counters c = { 0 };
+    ret = read_counters(&c);
+    if (ret == 0) print_counters(&c, NULL);
+  } else if (!strcmp(cmd, "monitor")) {
+    const long interval_ms = argc >= 2 ? strtol(argv[1], NULL, 0) : 1000;
+    const struct timespec ts = { interval_ms / 1000, (interval_ms % 1000) * 1000000 };
+    dj_counters prev, c;
+    ret = read_counters(&prev);
+    while (ret == 0) {
+      nanosleep(&ts, NULL);
+      ret = read_counters(&c);
+      if (ret < 0) break;
+      printf("\n--- last %ld ms ---\n", interval_ms);
+      print_counters(&c, &prev);
+      fflush(stdout);
+      prev = c;
+    }
+  } else if (!strcmp(cmd, "reset-counters")) {
+    ret = command(DJ_CMD_RESET, DJ_BLOCK_COUNTERS, 0, 0, &resp);
+  } else if (!strcmp(cmd, "histograms")) {
+    dj_histograms h = { 0 };
+    ret = read_block(DJ_BLOCK_HISTOGRAMS, (uint32_t *)&h, sizeof(h) / sizeof(uint32_t));
+    if (ret == 0) {
+      print_histogram("edge to queued report:", h.queued);
+      print_histogram("\nedge to completed report:", h.completed);
+    }
+  } else if (!strcmp(cmd, "reset-histograms")) {
+    ret = command(DJ_CMD_RESET, DJ_BLOCK_HISTOGRAMS, 0, 0, &resp);
+  } else if (!strcmp(cmd, "boot")) {
+    dj_boot b = { 0 };
+    ret = read_block(DJ_BLOCK_BOOT, (uint32_t *)&b, sizeof(b) / sizeof(uint32_t));
+    if (ret == 0) print_boot(&b);
+  } else if (!strcmp(cmd, "trace")) {
+    ret = print_trace();
+  } else if (!strcmp(cmd, "reset-trace")) {
+    ret = command(DJ_CMD_RESET, DJ_BLOCK_TRACE, 0, 0, &resp);
+  } else if (!strcmp(cmd, "profile")) {
+    dj_profile prof = { 0 };
+    ret = read_block(DJ_BLOCK_PROFILE, (uint32_t *)&prof, sizeof(prof) / sizeof(uint32_t));
+    if (ret == 0) print_profile(&prof);
+  } else if (!strcmp(cmd, "reset-profile")) {
+    ret = command(DJ_CMD_RESET, DJ_BLOCK_PROFILE, 0, 0, &resp);
+  } else {
+    usage();
+  }
+
+  close(fd);
+  return ret < 0 ? 1 : 0;
+}
@@ -0,0 +1,653 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Replays a trace recorded by the device (dualjoyctl trace) through the input
+// pipeline and the report builders of the firmware, and prints the reports
+// the device would have sent. The host is assumed to pick up every report
+// right away, autofire and the mouse motion are not replayed.
+//
+// With -c the replay is checked against the invariants of the pipeline, with
+// -g it runs on random bouncy waveforms instead of a recorded trace. -b
+// replaces the instant host with the interrupt endpoints: a report occupies
+// its endpoint until the host polls it on the 1 ms frame clock, every
+// poll_interval_ms frames, and a share of the polls can be lost to a busy bus.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "input.h"
+#include "reports.h"
+#include "mouse.h"
+#include "protocol.h"
+
+typedef struct {
+  const char *name;
+  size_t offset;
+  uint8_t size;   // of one element
+  uint8_t count;
+} param_info;
+
+#define DJ_PARAM_INFO(_id, _name, _count, _field) \
+  [_id] = { _name, offsetof(dualjoy_config, _field), sizeof(config._field) / (_count), _count },
+static const param_info params[DJ_PARAM_NUM] = {
+  DJ_PARAMS(DJ_PARAM_INFO)
+};
+#undef DJ_PARAM_INFO
+
+typedef struct {
+  uint32_t time_us;
+  uint32_t pins;
+  uint32_t states;
+} sample;
+
+enum {
+  LOOP_US = 1000,             // sample period of the main loop
+  LOOP_JITTER_US = 300,
+  SETTLED_STEP_US = 1000000,  // samples without pending changes only expire times
+  GEN_CYCLES = 2000,
+  GEN_MAX_BURST_US = 3000,
+  GEN_WRAP_SPREAD_US = 5000000,
+  FRAME_US = 1000,            // full speed frame
+  DRAIN_MAX_US = 1000000,     // until the endpoints must be idle after the input settled
+};
+
+dualjoy_config config;
+dj_counters counters;
+
+static uint32_t now;
+static uint32_t queued;
+static bool quiet;
+
+//--------------------------------------------------------------------+
+// Invariant checks
+//--------------------------------------------------------------------+
+
+static bool check;
+static uint32_t violations;
+static uint32_t window_min_us;  // lower bound of the lockout windows
+static uint32_t window_max_us;  // upper bound
+static uint64_t clock_us;       // now without the wraparound
+static uint32_t raw_pins;       // pins of the previous sample
+static uint64_t raw_change_us[TOTAL_PIN_NUM];
+static uint64_t edge_us[TOTAL_PIN_NUM];
+static bool edge_seen[TOTAL_PIN_NUM];
+
+static uint32_t start_us;       // now at clock_us 0
+
+static void violation(const char *what, const int pin) {
+  violations++;
+  if (pin < 0) printf("%10u violation: %s\n", now, what);
+  else printf("%10u violation: %s, pin %d (gpio %u)\n", now, what, pin, config.gpios[pin]);
+}
+
+static void setup_checks(void) {
+  switch (config.debounce_mode) {
+    case DEBOUNCE_ADAPTIVE:
+      window_min_us = config.debounce_us < DEBOUNCE_MIN_US ? config.debounce_us : DEBOUNCE_MIN_US;
+      window_max_us = config.debounce_us > DEBOUNCE_MAX_US ? config.debounce_us : DEBOUNCE_MAX_US;
+      break;
+    case DEBOUNCE_OVERSAMPLE:
+      window_min_us = window_max_us = 0;
+      break;
+    default:
+      window_min_us = window_max_us = config.debounce_us;
+      break;
+  }
+}
+
+// raw and debounced pins around one sample
+static void check_sample(const uint32_t pins, const uint32_t before, const uint32_t after) {
+  const uint64_t t = clock_us;
+
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    const uint32_t mask = 1u << config.gpios[i];
+    if ((pins ^ raw_pins) & mask) raw_change_us[i] = t;
+
+    if ((before ^ after) & mask) {
+      // a debounced edge needs a raw change and a passed lockout
+      if (!((after ^ before) & (pins ^ before) & mask)) violation("spurious edge", i);
+      if (edge_seen[i] && t - edge_us[i] < window_min_us) violation("edge within the lockout", i);
+      edge_us[i] = t;
+      edge_seen[i] = true;
+    }
+    // once a raw level was stable for longer than any lockout, it must have
+    // been accepted, otherwise it was lost or is late
+    if (((pins ^ after) & mask) && t - raw_change_us[i] > window_max_us + 1) {
+      violation("stable level not accepted", i);
+      raw_change_us[i] = t; // report it once per lockout
+    }
+  }
+  raw_pins = pins;
+}
+
+static void check_report(const uint8_t instance, const uint8_t report_id, const uint8_t *r, const uint16_t len) {
+  switch (config.usb_mode) {
+    case USB_MODE_GAMEPAD:
+      if (len != 2 || r[0] > 8 || r[1] > 1) violation("invalid gamepad report", -1);
+      break;
+    case USB_MODE_COMBINED:
+      for (uint8_t p = 0; p < PORT_NUM; p++) {
+        if (r[p] > 8) violation("invalid hat", -1);
+      }
+      if (r[PORT_NUM] >> PORT_NUM) violation("invalid buttons", -1);
+      break;
+    case USB_MODE_XINPUT:
+      // no opposing D-pad directions
+      if ((r[2] & 0x03) == 0x03 || (r[2] & 0x0c) == 0x0c) violation("invalid D-pad", -1);
+      break;
+    default:
+      break;
+  }
+  (void) instance;
+  (void) report_id;
+}
+
+//--------------------------------------------------------------------+
+// Interrupt endpoints
+//--------------------------------------------------------------------+
+
+typedef struct {
+  bool busy;            // a report waits for the poll
+  uint8_t id;
+  uint16_t len;
+  uint8_t data[REPORTS_MAX_LEN];
+  uint16_t delivered_len;
+  uint8_t delivered[REPORTS_MAX_LEN];
+} endpoint;
+
+static bool bus;
+static uint32_t bus_loss;         // percent of the polls lost
+static uint64_t next_poll_us;
+static endpoint endpoints[PORT_NUM];
+static bool retry;                // a report waited for a busy endpoint
+static bool undelivered;          // reports were queued since the last check_delivered()
+static uint8_t edge_pending;      // ports with an edge that isn't delivered yet
+static uint64_t port_edge_us[PORT_NUM];
+static uint32_t delivered;
+static uint32_t latency_max_us;   // from the edge to the delivery
+
+static uint32_t rnd(void);
+
+static void print_report(const uint32_t t, const uint8_t instance, const uint8_t report_id,
+                         const uint8_t *r, const uint16_t len) {
+  if (quiet) return;
+  printf("%10u %u %02x ", t, instance, report_id);
+  for (uint16_t i = 0; i < len; i++) printf("%02x", r[i]);
+  printf("\n");
+}
+
+static bool bus_pending(void) {
+  if (retry) return true;
+  for (uint8_t i = 0; i < PORT_NUM; i++) {
+    if (endpoints[i].busy) return true;
+  }
+  return false;
+}
+
+// the host polls the endpoints of all frames up to t, like the DCD it
+// completes the transfers of the polled ones
+static void bus_poll(const uint64_t t) {
+  const uint64_t interval = (uint64_t)config.poll_interval_ms * FRAME_US;
+
+  if (!bus_pending()) {
+    // nothing to pick up, skip to the next poll after t
+    if (next_poll_us <= t) next_poll_us += (t - next_poll_us) / interval * interval + interval;
+    return;
+  }
+  for (; next_poll_us <= t; next_poll_us += interval) {
+    for (uint8_t i = 0; i < PORT_NUM; i++) {
+      endpoint *ep = &endpoints[i];
+      if (!ep->busy || rnd() % 100 < bus_loss) continue;
+
+      ep->busy = false;
+      memcpy(ep->delivered, ep->data, ep->len);
+      ep->delivered_len = ep->len;
+      delivered++;
+      print_report(start_us + (uint32_t)next_poll_us, i, ep->id, ep->data, ep->len);
+
+      const uint8_t ports = reports_ports(i) & edge_pending;
+      for (uint8_t p = 0; p < PORT_NUM; p++) {
+        if (!(ports & (1 << p))) continue;
+        const uint64_t latency = next_poll_us - port_edge_us[p];
+        if (latency > latency_max_us) latency_max_us = latency;
+      }
+      edge_pending &= ~ports;
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// Platform hooks
+//--------------------------------------------------------------------+
+
+bool report_transmit(const uint8_t instance, const uint8_t report_id, const void *report, const uint16_t len) {
+  if (check) check_report(instance, report_id, report, len);
+  if (!bus) {
+    print_report(now, instance, report_id, report, len);
+    return true;
+  }
+
+  endpoint *ep = &endpoints[instance];
+  if (ep->busy) return false;
+  ep->busy = true;
+  undelivered = true;
+  ep->id = report_id;
+  ep->len = len;
+  memcpy(ep->data, report, len);
+  return true;
+}
+
+bool report_ready(const uint8_t instance) {
+  if (!bus || !endpoints[instance].busy) return true;
+  retry = true;
+  return false;
+}
+
+void report_queued(const uint8_t ports) {
+  (void) ports;
+  queued++;
+}
+
+void report_unchanged(const uint8_t ports) {
+  edge_pending &= ~ports; // the edges didn't change the report
+}
+
+void report_failed(void) {
+}
+
+void mouse_direction(const uint8_t pins) {
+  (void) pins;
+}
+
+bool mouse_take(int8_t *dx, int8_t *dy) {
+  *dx = *dy = 0;
+  return false;
+}
+
+//--------------------------------------------------------------------+
+// Replay
+//--------------------------------------------------------------------+
+
+static report ports[PORT_NUM];
+
+// the state at the first sample is sent in any case, like after the mount
+static void start(const uint32_t time_us, const uint32_t states) {
+  input_setup_pins();
+  input_setup_decoders();
+  input_setup_debounce();
+  reports_select(config.usb_mode);
+  setup_checks();
+
+  input_preset(states);
+  raw_pins = input_states();
+  now = start_us = time_us;
+  clock_us = 0;
+  memset(edge_seen, 0, sizeof(edge_seen));
+  memset(raw_change_us, 0, sizeof(raw_change_us));
+
+  next_poll_us = 0;
+  memset(endpoints, 0, sizeof(endpoints));
+  retry = undelivered = false;
+  edge_pending = 0;
+  for (uint8_t p = 0; p < PORT_NUM; p++) ports[p] = input_decode(p);
+  input_decode_changed(ports);
+  reports_resend();
+}
+
+// Once the endpoints are idle again, the host has to have the reports of the
+// current state, whatever was dropped on the way. Those are the ones a
+// resend would queue now.
+static void check_delivered(void) {
+  endpoint last[PORT_NUM];
+  memcpy(last, endpoints, sizeof(last));
+  const uint32_t q = queued;
+  const bool quiet_reports = quiet;
+
+  quiet = true;
+  reports_resend();
+  reports_send(ports);
+  for (uint8_t i = 0; i < PORT_NUM; i++) {
+    const endpoint *ep = &endpoints[i];
+    if (ep->busy && (ep->len != last[i].delivered_len || memcmp(ep->data, last[i].delivered, ep->len))) {
+      violation("the host missed the current state", -1);
+    }
+  }
+  memcpy(endpoints, last, sizeof(last));
+  queued = q;
+  quiet = quiet_reports;
+  undelivered = false;
+}
+
+// until the next sample the replay needs
+static uint32_t step(void) {
+  return bus && bus_pending() ? LOOP_US : SETTLED_STEP_US;
+}
+
+// one iteration of the main loop
+static void feed(const uint32_t time_us, uint32_t pins) {
+  clock_us += time_us - now; // the steps are far below 2^32 us
+  now = time_us;
+  pins &= input_pin_mask();
+  if (bus) bus_poll(clock_us);
+  retry = false;
+
+  const uint32_t before = input_states();
+  const uint8_t edge_ports = input_update(pins, now);
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if ((edge_ports & (1 << p)) && !(edge_pending & (1 << p))) port_edge_us[p] = clock_us;
+  }
+  edge_pending |= edge_ports;
+  if (check) check_sample(pins, before, input_states());
+  input_decode_changed(ports);
+  reports_send(ports);
+  if (check && undelivered && !bus_pending()) check_delivered();
+}
+
+// lets the main loop run until the endpoints are idle
+static void drain(const uint32_t pins) {
+  if (!bus) return;
+  for (uint32_t t = 0; bus_pending() && t < DRAIN_MAX_US; t += LOOP_US) feed(now + LOOP_US, pins);
+  if (check && bus_pending()) violation("endpoints still busy", -1);
+}
+
+// The device samples every loop, but only records the samples that change
+// something. In between it saw the pins of the last recorded sample, which
+// only expire the lockout and idle times. Those are fed once per
+// SETTLED_STEP_US, which is plenty for that, unless reports wait for the
+// host.
+static void replay(const sample *samples, const size_t n) {
+  start(samples[0].time_us, samples[0].states);
+  for (size_t i = 0; i < n; i++) {
+    const uint32_t states = input_states();
+    feed(samples[i].time_us, samples[i].pins);
+    if (check && samples[i].states != states) violation("replay diverged from the recorded debounced state", -1);
+    if (i + 1 == n) break;
+
+    const uint32_t gap = samples[i + 1].time_us - samples[i].time_us;
+    for (uint32_t t = 0; gap - t > step();) {
+      t += step();
+      feed(samples[i].time_us + t, samples[i].pins);
+    }
+  }
+  drain(samples[n - 1].pins);
+}
+
+//--------------------------------------------------------------------+
+// Random waveforms
+//--------------------------------------------------------------------+
+
+static uint32_t rng = 1;
+
+static uint32_t rnd(void) {
+  // xorshift32
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static uint32_t rnd_range(const uint32_t lo, const uint32_t hi) {
+  return lo + rnd() % (hi - lo + 1);
+}
+
+static uint32_t gen_time;   // time of the waveform
+static uint32_t gen_pins;   // its current raw pins
+static uint32_t gen_due;    // until the next sample
+
+// samples the waveform like the main loop for duration us
+static void hold(uint32_t duration) {
+  while (gen_due <= duration) {
+    gen_time += gen_due;
+    duration -= gen_due;
+    feed(gen_time, gen_pins);
+    gen_due = gen_pins == input_states() && step() == SETTLED_STEP_US ? SETTLED_STEP_US :
+              rnd_range(LOOP_US - LOOP_JITTER_US, LOOP_US + LOOP_JITTER_US);
+  }
+  gen_time += duration;
+  gen_due -= duration;
+}
+
+static void toggle(const uint32_t mask) {
+  gen_pins ^= mask;
+  // the loop is running all the time, it sees the change within a period
+  if (gen_due > LOOP_US) gen_due = rnd_range(1, LOOP_US);
+}
+
+// Toggles random pins with bounce bursts shorter than the lockout, holds
+// the levels from a few microseconds (taps, glitches) up to seconds, and now
+// and then stays idle for about 2^32 us, so that the clock wraps around
+// where the last lockouts ended.
+static void generate(const uint32_t seed) {
+  rng = seed ? seed : 1;
+  gen_time = rnd();
+  gen_pins = 0;
+  gen_due = 1;
+  start(gen_time, 0);
+
+  const uint32_t burst_max = window_min_us / 2 < GEN_MAX_BURST_US ? window_min_us / 2 : GEN_MAX_BURST_US;
+  for (uint32_t c = 0; c < GEN_CYCLES; c++) {
+    const uint32_t mask = 1u << config.gpios[rnd() % TOTAL_PIN_NUM];
+
+    // bounces, the final level is the toggled one
+    const uint32_t bounces = burst_max ? 2 * (rnd() % 3) : 0;
+    for (uint32_t b = 0; b < bounces; b++) {
+      toggle(mask);
+      hold(rnd_range(1, burst_max / (bounces + 1)));
+    }
+    toggle(mask);
+
+    switch (rnd() % 16) {
+      case 0:
+        hold(0xffffffffu - rnd_range(0, GEN_WRAP_SPREAD_US));
+        break;
+      case 1:
+      case 2:
+        hold(rnd_range(1, window_max_us + 1)); // tap
+        break;
+      default:
+        hold(rnd_range(window_max_us + 1, 300000));
+        break;
+    }
+  }
+  hold(window_max_us + 2 * LOOP_US);
+  drain(gen_pins);
+}
+
+//--------------------------------------------------------------------+
+// Trace file
+//--------------------------------------------------------------------+
+
+// debounce_window, the windows at the start of the trace, goes into
+// learned_debounce_us, so an adaptive replay starts from them
+static bool set_param(const char *name, char *values) {
+  for (uint8_t id = 0; id < DJ_PARAM_NUM; id++) {
+    const param_info *p = &params[id];
+    if (strcmp(p->name, name)) continue;
+
+    for (uint8_t i = 0; i < p->count; i++) {
+      char *end;
+      const uint32_t v = strtoul(values, &end, 0);
+      if (end == values) return false;
+      values = end;
+      memcpy((uint8_t *)&config + p->offset + i * p->size, &v, p->size);
+    }
+    return true;
+  }
+  return false;
+}
+
+// reads the params into config and returns the samples
+static sample *read_trace(FILE *f, size_t *n) {
+  size_t cap = 1024;
+  sample *samples = malloc(cap * sizeof(sample));
+  char line[256];
+  unsigned lineno = 0;
+
+  *n = 0;
+  while (samples && fgets(line, sizeof(line), f)) {
+    lineno++;
+    char name[32];
+    int len;
+    if (line[0] == '#' || sscanf(line, "%31s %n", name, &len) < 1) continue;
+
+    if (!strcmp(name, "sample")) {
+      sample s;
+      if (sscanf(line + len, "%u %x %x", &s.time_us, &s.pins, &s.states) != 3) goto error;
+      if (*n == cap) samples = realloc(samples, (cap *= 2) * sizeof(sample));
+      if (samples) samples[(*n)++] = s;
+    } else if (!set_param(name, line + len)) {
+      goto error;
+    }
+  }
+  return samples;
+
+error:
+  fprintf(stderr, "line %u: invalid: %s", lineno, line);
+  free(samples);
+  return NULL;
+}
+
+// the parts of config_valid() the pipeline relies on
+static bool config_usable(void) {
+  uint32_t used = 0;
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    if (config.gpios[i] >= 32 || (used & (1u << config.gpios[i]))) return false;
+    used |= 1u << config.gpios[i];
+  }
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (config.port_protocol[p] >= PORT_PROTOCOL_NUM) return false;
+    if (config.dir_mode[p] >= DIR_MODE_NUM || config.socd_mode[p] >= SOCD_MODE_NUM) return false;
+  }
+  return config.debounce_mode <= DEBOUNCE_OVERSAMPLE && config.usb_mode < USB_MODE_NUM &&
+         config.mouse_port < PORT_NUM;
+}
+
+static void run(const sample *samples, const size_t n, const long seed) {
+  if (seed >= 0) {
+    generate(seed);
+  } else if (n) {
+    rng = 1;
+    replay(samples, n);
+  }
+}
+
+// Replays the input once per combination of the USB modes and the settings
+// of states2direction(), with the rest of the config from the trace. With a
+// fixed input the output only changes when the reports do, so it can be
+// diffed between two builds.
+static void run_all(const sample *samples, const size_t n, const long seed) {
+  const dualjoy_config base = config;
+
+  for (uint8_t mode = 0; mode < USB_MODE_NUM; mode++) {
+    for (uint8_t protocol = 0; protocol < PORT_PROTOCOL_NUM; protocol++) {
+      for (uint8_t dir = 0; dir < DIR_MODE_NUM; dir++) {
+        for (uint8_t socd = 0; socd < SOCD_MODE_NUM; socd++) {
+          config = base;
+          config.usb_mode = mode;
+          for (uint8_t p = 0; p < PORT_NUM; p++) {
+            config.port_protocol[p] = protocol;
+            config.dir_mode[p] = dir;
+            config.socd_mode[p] = socd;
+          }
+          printf("# usb_mode %u port_protocol %u dir_mode %u socd_mode %u\n", mode, protocol, dir, socd);
+          run(samples, n, seed);
+        }
+      }
+    }
+  }
+}
+
+static void usage(void) {
+  fprintf(stderr,
+    "usage: dualjoyreplay [-c] [-q] [-b loss] [-g seed] [-a | -m usb_mode] [trace]\n"
+    "Replays a trace from 'dualjoyctl trace' (or stdin) and prints the reports as\n"
+    "  time_us instance report_id bytes\n"
+    "report_id 00 is an XInput report.\n"
+    "  -c       check the invariants of the pipeline, exit with 1 on violations\n"
+    "  -q       don't print the reports\n"
+    "  -b loss  let the host poll the endpoints every poll_interval_ms and lose\n"
+    "           loss %% of the polls, reports are printed when they are polled\n"
+    "  -g seed  replay random waveforms instead of the samples of the trace\n"
+    "  -m mode  replay in another USB mode\n"
+    "  -a       replay in every USB mode, port protocol, dir_mode and socd_mode\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  int mode = -1;
+  long seed = -1;
+  bool all = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "acqb:g:m:h")) != -1) {
+    if (opt == 'a') all = true;
+    else if (opt == 'c') check = true;
+    else if (opt == 'q') quiet = true;
+    else if (opt == 'b') bus = true, bus_loss = strtoul(optarg, NULL, 0);
+    else if (opt == 'g') seed = strtol(optarg, NULL, 0);
+    else if (opt == 'm') mode = strtol(optarg, NULL, 0);
+    else usage();
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc > 1 || (all && mode >= 0)) usage();
+
+  FILE *f = argc ? fopen(argv[0], "r") : stdin;
+  if (!f) {
+    perror(argv[0]);
+    return 1;
+  }
+  size_t n;
+  sample *samples = read_trace(f, &n);
+  if (f != stdin) fclose(f);
+  if (!samples) return 1;
+
+  // only the adaptive mode starts from learned windows
+  if (config.debounce_mode != DEBOUNCE_ADAPTIVE) memset(config.learned_debounce_us, 0, sizeof(config.learned_debounce_us));
+  if (mode >= 0) config.usb_mode = mode;
+  if (!config_usable() || (bus && (config.poll_interval_ms < 1 || bus_loss > 99))) {
+    fprintf(stderr, "invalid config in the trace\n");
+    return 1;
+  }
+  if (config.autofire_hz[0] || config.autofire_hz[1]) {
+    fprintf(stderr, "note: autofire is not replayed\n");
+  }
+
+  if (all) run_all(samples, n, seed);
+  else run(samples, n, seed);
+
+  uint32_t rejections = 0;
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) rejections += counters.rejections[i];
+  fprintf(stderr, "%u samples, %u edges, %u rejections, %u reports", counters.samples, counters.edges,
+          rejections, queued);
+  if (bus) fprintf(stderr, ", %u delivered, max latency %u us", delivered, latency_max_us);
+  if (check) fprintf(stderr, ", %u violations", violations);
+  fprintf(stderr, "\n");
+  free(samples);
+  return violations ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Stands in for libFuzzer where the compiler has none (GCC): runs the
+// target on the files given, or on random inputs. Takes the libFuzzer
+// options the tests use, so both builds run the same command.
+//
+//   fuzz_<target> [-runs=N] [-seed=N] [-max_len=N] [file...]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint32_t rng;
+
+static uint32_t xorshift(void) {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static int run_file(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+  static uint8_t data[1 << 20];
+  const size_t size = fread(data, 1, sizeof(data), f);
+  fclose(f);
+  LLVMFuzzerTestOneInput(data, size);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  unsigned long runs = 10000;
+  unsigned long max_len = 4096;
+  unsigned long files = 0;
+  rng = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "-runs=", 6)) runs = strtoul(argv[i] + 6, NULL, 0);
+    else if (!strncmp(argv[i], "-seed=", 6)) rng = strtoul(argv[i] + 6, NULL, 0) | 1;
+    else if (!strncmp(argv[i], "-max_len=", 9)) max_len = strtoul(argv[i] + 9, NULL, 0);
+    else if (argv[i][0] == '-') continue; // other libFuzzer options
+    else if (run_file(argv[i])) return 1;
+    else files++;
+  }
+  if (files) return 0;
+
+  uint8_t *data = malloc(max_len ? max_len : 1);
+  if (!data) return 1;
+  for (unsigned long r = 0; r < runs; r++) {
+    const size_t size = max_len ? xorshift() % (max_len + 1) : 0;
+    for (size_t i = 0; i < size; i++) data[i] = xorshift();
+    LLVMFuzzerTestOneInput(data, size);
+  }
+  free(data);
+  printf("%lu random inputs\n", runs);
+  return 0;
+}
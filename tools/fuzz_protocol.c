@@ -0,0 +1,231 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Fuzzes the config protocol the way the host reaches it, through the
+// SET_REPORT and GET_REPORT of the feature report, and the GET_REPORT of the
+// input reports. protocol.c, config.c, input.c and reports.c are the ones of
+// the firmware, the hooks of dualjoy.c are replaced below.
+//
+// Every input starts from a fresh boot with the default config and is a
+// sequence of operations. After each of them the config has to pass
+// config_valid() and every port has to decode its boot time GPIOs, so a
+// request that corrupts the config or the decoders aborts.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "input.h"
+#include "reports.h"
+#include "mouse.h"
+#include "protocol.h"
+
+#define require(_cond) do { \
+    if (!(_cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #_cond); abort(); } \
+  } while (0)
+
+dj_counters counters;
+dj_histograms histograms;
+dj_boot boot;
+dj_trace input_trace;
+
+//--------------------------------------------------------------------+
+// Hooks of dualjoy.c
+//--------------------------------------------------------------------+
+
+void dualjoy_config_changed(const uint8_t param) {
+  const bool all = param == DJ_PARAM_NUM;
+
+  if (all || param == DJ_PARAM_DEBOUNCE_MODE || param == DJ_PARAM_DEBOUNCE_US) {
+    input_setup_debounce();
+  }
+  if (all || param == DJ_PARAM_PORT_PROTOCOL || param == DJ_PARAM_DIR_MODE ||
+      param == DJ_PARAM_SOCD_MODE || param == DJ_PARAM_AUTOFIRE_HZ || param == DJ_PARAM_AUTOFIRE_DUTY) {
+    input_setup_decoders();
+  }
+  dualjoy_reset_trace();
+}
+
+void dualjoy_request_save(void) {
+}
+
+uint32_t dualjoy_debounce_window(const uint8_t pin) {
+  return input_debounce_window(pin);
+}
+
+void dualjoy_reset_trace(void) {
+  input_trace.count = 0;
+  input_trace.frozen = false;
+}
+
+//--------------------------------------------------------------------+
+// Platform hooks of reports.c
+//--------------------------------------------------------------------+
+
+bool report_transmit(const uint8_t instance, const uint8_t report_id, const void *report, const uint16_t len) {
+  (void) instance; (void) report_id; (void) report;
+  require(len <= REPORTS_MAX_LEN);
+  return true;
+}
+
+bool report_ready(const uint8_t instance) {
+  (void) instance;
+  return true;
+}
+
+void report_queued(const uint8_t ports) {
+  (void) ports;
+}
+
+void report_unchanged(const uint8_t ports) {
+  (void) ports;
+}
+
+void report_failed(void) {
+}
+
+void mouse_direction(const uint8_t pins) {
+  (void) pins;
+}
+
+bool mouse_take(int8_t *dx, int8_t *dy) {
+  *dx = *dy = 0;
+  return false;
+}
+
+//--------------------------------------------------------------------+
+// Operations
+//--------------------------------------------------------------------+
+
+typedef struct {
+  const uint8_t *data;
+  size_t size;
+} input;
+
+static uint8_t next(input *in) {
+  if (!in->size) return 0;
+  in->size--;
+  return *in->data++;
+}
+
+static void boot_device(void) {
+  config_set_defaults(&config);
+  input_setup_pins();
+  input_setup_decoders();
+  input_setup_debounce();
+  reports_select(config.usb_mode);
+  memset(&input_trace, 0, sizeof(input_trace));
+  input_preset(0);
+}
+
+// the host reads the answer of the last request with GET_REPORT
+static void get_answer(input *in) {
+  uint8_t buf[64];
+  const uint16_t reqlen = next(in) % (sizeof(buf) + 1);
+  const uint16_t len = protocol_get_report(buf, reqlen);
+  require(len == 0 || (len == sizeof(dj_feature) && len <= reqlen));
+  if (!len) return;
+
+  dj_feature resp;
+  memcpy(&resp, buf, sizeof(resp));
+  require(resp.status <= DJ_ERR_READONLY && resp.count <= DJ_BLOCK_WORDS);
+}
+
+// arbitrary bytes as SET_REPORT, of any length
+static void set_raw(input *in) {
+  uint8_t buf[2 * sizeof(dj_feature)];
+  const uint16_t bufsize = next(in) % (sizeof(buf) + 1);
+  for (uint16_t i = 0; i < bufsize; i++) buf[i] = next(in);
+  protocol_set_report(buf, bufsize);
+}
+
+// a request with the fields close to their ranges, to get past the checks
+static void set_request(input *in) {
+  dj_feature req = { 0 };
+  req.cmd = next(in) % (DJ_CMD_RESET + 2);
+  req.id = next(in) % (DJ_PARAM_NUM + 1);
+  req.index = next(in) % (TOTAL_PIN_NUM + 1);
+  req.seq = next(in);
+  const uint8_t kind = next(in);
+  if (kind & 1) {
+    req.value = next(in);
+  } else {
+    for (uint8_t i = 0; i < 4; i++) req.value |= (uint32_t)next(in) << (8 * i);
+  }
+  protocol_set_report((const uint8_t *)&req, sizeof(req));
+}
+
+// debounced pin states, the reports built from them and their GET_REPORT
+static void get_input_report(input *in) {
+  uint32_t pins = 0;
+  for (uint8_t i = 0; i < 4; i++) pins |= (uint32_t)next(in) << (8 * i);
+  input_preset(pins);
+
+  report r[PORT_NUM];
+  for (uint8_t p = 0; p < PORT_NUM; p++) r[p] = input_decode(p);
+  reports_send(r);
+
+  uint8_t buf[REPORTS_MAX_LEN + 8];
+  const uint8_t instance = next(in) % 4;
+  const uint8_t report_id = next(in) % (COMBINED_REPORT_ID + 2);
+  const uint16_t len = next(in) % (sizeof(buf) + 1);
+  require(reports_get(instance, report_id, buf, len) <= len);
+}
+
+// a single pin of a port must decode to that pin, with the GPIOs sampled
+// since the boot, whatever the config says now
+static void check_decoders(void) {
+  static const uint8_t directions[PIN_NUM] = { [UP] = 0, [DOWN] = 4, [LEFT] = 6, [RIGHT] = 2, [BTN] = 8 };
+
+  for (uint8_t p = 0; p < PORT_NUM; p++) {
+    if (config.port_protocol[p] != PORT_JOYSTICK) continue;
+    for (uint8_t i = 0; i < PIN_NUM; i++) {
+      input_preset(1u << input_gpio(p * PIN_NUM + i));
+      const report r = input_decode(p);
+      require(r.direction == directions[i]);
+      require(r.buttons == (i == BTN));
+    }
+  }
+  input_preset(0);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  input in = { data, size };
+
+  boot_device();
+  while (in.size) {
+    switch (next(&in) % 4) {
+      case 0: set_raw(&in); break;
+      case 1: set_request(&in); break;
+      case 2: get_answer(&in); break;
+      case 3: get_input_report(&in); break;
+    }
+    require(config_valid(&config));
+    check_decoders();
+  }
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Fuzzes the descriptor callbacks of usb_descriptors.c with the mode, the
+// polling interval and the requests the host controls, against the real
+// TinyUSB headers. The descriptors have to stay well formed: every one
+// within the configuration and at least 2 bytes long (the class drivers
+// walk them by their length), the HID endpoints at the interval latched
+// at boot and the strings within their buffer.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bsp/board_api.h"
+#include "tusb.h"
+#include "config.h"
+
+#define require(_cond) do { \
+    if (!(_cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #_cond); abort(); } \
+  } while (0)
+
+dualjoy_config config;
+
+size_t board_usb_get_serial(uint16_t desc_str[], size_t max_chars) {
+  static const char serial[] = "E6614103E7452D2F";
+  size_t i;
+  for (i = 0; i < max_chars && serial[i]; i++) desc_str[i] = serial[i];
+  return i;
+}
+
+static uint16_t control_len;
+static uint8_t boot_usb_mode;
+static uint8_t boot_poll_interval_ms;
+
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const *request, void *buffer, uint16_t len) {
+  (void) rhport; (void) request;
+  require(buffer && len);
+  control_len = len;
+  return true;
+}
+
+static void check_configuration(const uint8_t index) {
+  const uint8_t *desc = tud_descriptor_configuration_cb(index);
+  if (index >= USB_MODE_NUM) {
+    require(desc == NULL);
+    return;
+  }
+  require(desc != NULL);
+
+  const tusb_desc_configuration_t *c = (const tusb_desc_configuration_t *)desc;
+  require(c->bDescriptorType == TUSB_DESC_CONFIGURATION);
+  require(c->bConfigurationValue == index + 1);
+
+  const uint16_t total = tu_le16toh(c->wTotalLength);
+  uint8_t interfaces = 0;
+  bool hid = false;
+  for (const uint8_t *d = desc; d < desc + total; d += d[0]) {
+    require(d[0] >= 2 && d + d[0] <= desc + total);
+    if (d[1] == TUSB_DESC_INTERFACE) {
+      const tusb_desc_interface_t *itf = (const tusb_desc_interface_t *)d;
+      hid = itf->bInterfaceClass == TUSB_CLASS_HID;
+      if (itf->bAlternateSetting == 0) interfaces++;
+    } else if (d[1] == TUSB_DESC_ENDPOINT && hid) {
+      require(((const tusb_desc_endpoint_t *)d)->bInterval == boot_poll_interval_ms);
+    }
+  }
+  require(interfaces == c->bNumInterfaces);
+
+  // the last fetched configuration is the one that gets mounted
+  const uint8_t mode = usb_mode_activate();
+  require(mode < USB_MODE_NUM && usb_active_mode() == mode);
+  require(index != 0 || mode == boot_usb_mode);
+  require(tud_hid_descriptor_report_cb(0) != NULL);
+}
+
+static void check_string(const uint8_t index, const uint16_t langid) {
+  const uint16_t *s = tud_descriptor_string_cb(index, langid);
+  if (!s) return;
+  const uint8_t len = s[0] & 0xff;
+  require((s[0] >> 8) == TUSB_DESC_STRING);
+  require(len >= 2 && len % 2 == 0 && len <= 2 * (32 + 1));
+}
+
+static void check_vendor(const uint8_t *data) {
+  tusb_control_request_t req;
+  memcpy(&req, data, sizeof(req));
+  control_len = 0;
+  if (!tud_vendor_control_xfer_cb(0, CONTROL_STAGE_SETUP, &req)) return;
+  require(control_len > 0);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size < 5 + sizeof(tusb_control_request_t)) return 0;
+
+  memset(&config, 0, sizeof(config));
+  config.usb_mode = data[0] % USB_MODE_NUM;
+  config.poll_interval_ms = 1 + data[1] % 32;
+  usb_latch_config();
+  boot_usb_mode = config.usb_mode;
+  boot_poll_interval_ms = config.poll_interval_ms;
+  require(usb_poll_interval_ms() == boot_poll_interval_ms);
+  // a SET of usb_mode or poll_interval_ms after the boot must not change
+  // the descriptors
+  config.usb_mode = data[0] / USB_MODE_NUM % USB_MODE_NUM;
+  config.poll_interval_ms = 1 + data[1] / 32 % 8;
+
+  const tusb_desc_device_t *dev = (const tusb_desc_device_t *)tud_descriptor_device_cb();
+  require(((dev->idProduct >> 8) & 0x0f) == boot_usb_mode);
+
+  check_configuration(data[2] % (USB_MODE_NUM + 1));
+  check_string(data[3], data[4]);
+  check_vendor(data + 5);
+  return 0;
+}
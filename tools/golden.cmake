@@ -0,0 +1,21 @@
+# Replays a trace of tests/golden with dualjoyreplay -a and compares the
+# reports with the .expected file next to it. After an intended change of
+# the reports, regenerate it:
+#
+#   build-tools/dualjoyreplay -a tests/golden/<name>.trace > tests/golden/<name>.expected
+#
+#   cmake -DREPLAY=<dualjoyreplay> -DTRACE=<trace> -DOUTPUT=<dir> -P golden.cmake
+
+get_filename_component(name ${TRACE} NAME_WE)
+get_filename_component(dir ${TRACE} DIRECTORY)
+set(actual ${OUTPUT}/${name}.actual)
+
+execute_process(COMMAND ${REPLAY} -a ${TRACE} OUTPUT_FILE ${actual} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "dualjoyreplay failed on ${TRACE}: ${result}")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${dir}/${name}.expected ${actual} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "reports changed, compare ${actual} with ${dir}/${name}.expected")
+endif()
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Runs dualjoy_bench in an emulator and prints its UART output, from the
+# banner to the "done" line. The emulator command gets the .elf appended and
+# has to write the UART (GPIO 0) to stdout. It is stopped once the benchmark
+# is done, or after BENCH_TIMEOUT seconds (600 by default).
+#
+#   run_bench.sh <emulator> [options...] dualjoy_bench.elf
+
+if [ $# -lt 2 ]; then
+  echo "usage: run_bench.sh <emulator> [options...] dualjoy_bench.elf" >&2
+  exit 2
+fi
+
+timeout=${BENCH_TIMEOUT:-600}
+out=$(mktemp) || exit 1
+trap 'rm -f "$out"' EXIT
+
+"$@" > "$out" 2>&1 &
+pid=$!
+
+elapsed=0
+while ! grep -q '^done' "$out"; do
+  if ! kill -0 $pid 2>/dev/null || [ $elapsed -ge "$timeout" ]; then
+    kill $pid 2>/dev/null
+    cat "$out"
+    echo "run_bench.sh: the benchmark didn't finish" >&2
+    exit 1
+  fi
+  sleep 1
+  elapsed=$((elapsed + 1))
+done
+kill $pid 2>/dev/null
+wait $pid 2>/dev/null
+
+sed -n '/^dualjoy_bench/,/^done/p' "$out"
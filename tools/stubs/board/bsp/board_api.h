@@ -0,0 +1,14 @@
+// The part of TinyUSB's board API usb_descriptors.c uses, for the host
+// harnesses in tools/.
+#ifndef STUBS_BSP_BOARD_API_H_
+#define STUBS_BSP_BOARD_API_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tusb.h"
+
+// fills desc_str with the serial number in UTF-16, returns its length
+size_t board_usb_get_serial(uint16_t desc_str[], size_t max_chars);
+
+#endif /* STUBS_BSP_BOARD_API_H_ */
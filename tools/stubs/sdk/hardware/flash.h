@@ -0,0 +1,19 @@
+#ifndef STUBS_HARDWARE_FLASH_H_
+#define STUBS_HARDWARE_FLASH_H_
+
+#include "pico/stdlib.h"
+
+#define XIP_BASE 0x10000000
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define FLASH_SECTOR_SIZE 4096
+#define FLASH_PAGE_SIZE 256
+
+static inline void flash_range_erase(uint32_t offset, size_t count) {
+  (void) offset; (void) count;
+}
+
+static inline void flash_range_program(uint32_t offset, const uint8_t *data, size_t count) {
+  (void) offset; (void) data; (void) count;
+}
+
+#endif /* STUBS_HARDWARE_FLASH_H_ */
@@ -0,0 +1,11 @@
+#ifndef STUBS_PICO_FLASH_H_
+#define STUBS_PICO_FLASH_H_
+
+#include "pico/stdlib.h"
+
+static inline int flash_safe_execute(void (*func)(void *), void *param, uint32_t timeout_ms) {
+  (void) func; (void) param; (void) timeout_ms;
+  return -1;
+}
+
+#endif /* STUBS_PICO_FLASH_H_ */
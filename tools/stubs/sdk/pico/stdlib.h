@@ -0,0 +1,15 @@
+// Just enough of the Pico SDK to build config.c for the host harnesses in
+// tools/, none of the flash functions are ever called there.
+#ifndef STUBS_PICO_STDLIB_H_
+#define STUBS_PICO_STDLIB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NUM_BANK0_GPIOS 30
+#define PICO_DEFAULT_LED_PIN 25
+#define PICO_OK 0
+#define __no_inline_not_in_flash_func(_name) _name
+
+#endif /* STUBS_PICO_STDLIB_H_ */
@@ -0,0 +1,16 @@
+// the HID key usages of the default config, as in TinyUSB's class/hid/hid.h
+#ifndef STUBS_TUSB_H_
+#define STUBS_TUSB_H_
+
+#define HID_KEY_A             0x04
+#define HID_KEY_D             0x07
+#define HID_KEY_S             0x16
+#define HID_KEY_W             0x1A
+#define HID_KEY_ARROW_RIGHT   0x4F
+#define HID_KEY_ARROW_LEFT    0x50
+#define HID_KEY_ARROW_DOWN    0x51
+#define HID_KEY_ARROW_UP      0x52
+#define HID_KEY_CONTROL_LEFT  0xE0
+#define HID_KEY_CONTROL_RIGHT 0xE4
+
+#endif /* STUBS_TUSB_H_ */
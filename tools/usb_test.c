@@ -0,0 +1,583 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Enumerates the device in every USB mode with TinyUSB's device stack and
+// HID driver, the XInput driver and usb_descriptors.c, against a mock of the
+// device controller driver (dcd_*) with a virtual 1 ms frame clock. The
+// host polls each interrupt IN endpoint every bInterval frames.
+//
+// For every mode and a few polling intervals latched at boot, with other
+// values SET into the config afterwards, it checks:
+// - the device and configuration descriptors, as the host reads them
+//   through control transfers, with the HID endpoints at the latched
+//   poll_interval_ms
+// - every configuration through SET_CONFIGURATION: the mode it maps to,
+//   that TinyUSB opens exactly its endpoints with their bInterval, and
+//   that its HID report descriptors can be read
+// - that a scripted input sequence reaches the host in order: every queued
+//   report is delivered exactly once, in the order it was queued and with
+//   a report ID of its interface, and the host ends up with the current
+//   state
+//
+// The application callbacks are the ones of dualjoy.c, reduced to what the
+// reports need.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bsp/board_api.h"
+#include "tusb.h"
+#include "device/dcd.h"
+
+#include "config.h"
+#include "input.h"
+#include "reports.h"
+#include "mouse.h"
+#include "protocol.h"
+#include "xinput.h"
+
+#define require(_cond) do { \
+    if (!(_cond)) { \
+      fprintf(stderr, "%s:%d: %s (usb_mode %u, poll_interval_ms %u, configuration %u, frame %u)\n", \
+              __FILE__, __LINE__, #_cond, boot_mode, usb_poll_interval_ms(), configuration, frame); \
+      exit(1); \
+    } \
+  } while (0)
+
+enum {
+  EP_NUM = 16,
+  LOG_LEN = 256,
+  DESC_MAX_LEN = 512,
+  SCRIPT_FRAMES = 80,
+};
+
+dj_counters counters;
+
+static uint32_t frame;
+static uint8_t boot_mode;      // usb_mode latched at boot
+static uint8_t configuration;  // index of the selected configuration
+
+//--------------------------------------------------------------------+
+// Mock device controller
+//--------------------------------------------------------------------+
+
+typedef struct {
+  bool open;
+  bool busy;
+  uint8_t interval;   // bInterval, in frames
+  uint8_t *buf;
+  uint16_t len;
+  int8_t instance;    // report instance of the transfer in flight
+} mock_endpoint;
+
+static mock_endpoint eps[EP_NUM][2];
+static bool ep0_stalled;
+static int8_t transmitting = -1;  // instance of the report_transmit() in progress
+
+#if TUSB_VERSION_MAJOR == 0 && TUSB_VERSION_MINOR < 17
+void dcd_init(uint8_t rhport) {
+  (void) rhport;
+}
+#else
+bool dcd_init(uint8_t rhport, const tusb_rhport_init_t *rh_init) {
+  (void) rhport; (void) rh_init;
+  return true;
+}
+#endif
+
+void dcd_int_handler(uint8_t rhport) { (void) rhport; }
+void dcd_int_enable(uint8_t rhport) { (void) rhport; }
+void dcd_int_disable(uint8_t rhport) { (void) rhport; }
+void dcd_remote_wakeup(uint8_t rhport) { (void) rhport; }
+void dcd_connect(uint8_t rhport) { (void) rhport; }
+void dcd_disconnect(uint8_t rhport) { (void) rhport; }
+void dcd_sof_enable(uint8_t rhport, bool en) { (void) rhport; (void) en; }
+
+void dcd_set_address(uint8_t rhport, uint8_t dev_addr) {
+  (void) dev_addr;
+  // the controller answers SET_ADDRESS with the status stage itself
+  dcd_edpt_xfer(rhport, 0x80, NULL, 0);
+}
+
+void dcd_edpt0_status_complete(uint8_t rhport, tusb_control_request_t const *request) {
+  (void) rhport; (void) request;
+}
+
+bool dcd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const *desc_ep) {
+  (void) rhport;
+  const uint8_t num = tu_edpt_number(desc_ep->bEndpointAddress);
+  require(num > 0 && num < EP_NUM);
+  mock_endpoint *ep = &eps[num][tu_edpt_dir(desc_ep->bEndpointAddress)];
+  require(!ep->open);
+  memset(ep, 0, sizeof(*ep));
+  ep->open = true;
+  ep->interval = desc_ep->bInterval;
+  ep->instance = -1;
+  return true;
+}
+
+// no isochronous endpoints in any configuration
+bool dcd_edpt_iso_alloc(uint8_t rhport, uint8_t ep_addr, uint16_t largest_packet_size) {
+  (void) rhport; (void) ep_addr; (void) largest_packet_size;
+  return false;
+}
+
+bool dcd_edpt_iso_activate(uint8_t rhport, tusb_desc_endpoint_t const *desc_ep) {
+  (void) rhport; (void) desc_ep;
+  return false;
+}
+
+void dcd_edpt_close_all(uint8_t rhport) {
+  (void) rhport;
+  for (uint8_t num = 1; num < EP_NUM; num++) memset(eps[num], 0, sizeof(eps[num]));
+}
+
+void dcd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  memset(&eps[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)], 0, sizeof(mock_endpoint));
+}
+
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint16_t total_bytes) {
+  (void) rhport;
+  const uint8_t num = tu_edpt_number(ep_addr);
+  mock_endpoint *ep = &eps[num][tu_edpt_dir(ep_addr)];
+  require(num == 0 || ep->open);
+  require(!ep->busy);
+  ep->busy = true;
+  ep->buf = buffer;
+  ep->len = total_bytes;
+  if (num && tu_edpt_dir(ep_addr) == TUSB_DIR_IN) {
+    require(transmitting >= 0);
+    ep->instance = transmitting;
+  }
+  return true;
+}
+
+void dcd_edpt_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  if (tu_edpt_number(ep_addr) == 0) {
+    ep0_stalled = true;
+    eps[0][TUSB_DIR_IN].busy = eps[0][TUSB_DIR_OUT].busy = false;
+  }
+}
+
+void dcd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport; (void) ep_addr;
+}
+
+// the OS glue of the device stack, on the virtual clock
+uint32_t tusb_time_millis_api(void) {
+  return frame;
+}
+
+void tusb_time_delay_ms_api(uint32_t ms) {
+  frame += ms;
+}
+
+size_t board_usb_get_serial(uint16_t desc_str[], size_t max_chars) {
+  static const char serial[] = "E6614103E7452D2F";
+  size_t i;
+  for (i = 0; i < max_chars && serial[i]; i++) desc_str[i] = serial[i];
+  return i;
+}
+
+//--------------------------------------------------------------------+
+// Host
+//--------------------------------------------------------------------+
+
+typedef struct {
+  uint8_t bytes[REPORTS_MAX_LEN + 1];
+  uint16_t len;
+  uint32_t frame;
+} packet;
+
+typedef struct {
+  packet queued[LOG_LEN];
+  packet delivered[LOG_LEN];
+  uint16_t queued_num;
+  uint16_t delivered_num;
+} instance_log;
+
+static instance_log logs[PORT_NUM];
+
+static void log_packet(packet *log, uint16_t *num, const uint8_t *bytes, const uint16_t len) {
+  require(*num < LOG_LEN && len <= sizeof(log->bytes));
+  packet *p = &log[(*num)++];
+  memcpy(p->bytes, bytes, len);
+  p->len = len;
+  p->frame = frame;
+}
+
+// runs a control transfer through the setup, data and status stages,
+// returns false if the device stalled it
+static bool control(const uint8_t type, const uint8_t request, const uint16_t value, const uint16_t index,
+                    uint8_t *data, const uint16_t length, uint16_t *done) {
+  const tusb_control_request_t req = {
+    .bmRequestType = type,
+    .bRequest = request,
+    .wValue = value,
+    .wIndex = index,
+    .wLength = length,
+  };
+  const bool in = type & TUSB_DIR_IN_MASK;
+  uint16_t n = 0;
+
+  ep0_stalled = false;
+  dcd_event_setup_received(0, (const uint8_t *)&req, false);
+  tud_task();
+  for (uint8_t stages = 0; stages < 64 && !ep0_stalled; stages++) {
+    mock_endpoint *ep_in = &eps[0][TUSB_DIR_IN];
+    mock_endpoint *ep_out = &eps[0][TUSB_DIR_OUT];
+    if (ep_in->busy) {
+      const uint16_t len = ep_in->len;
+      require(len == 0 || (in && n + len <= length));
+      if (len) memcpy(data + n, ep_in->buf, len);
+      n += len;
+      ep_in->busy = false;
+      dcd_event_xfer_complete(0, 0x80, len, XFER_RESULT_SUCCESS, false);
+    } else if (ep_out->busy) {
+      const uint16_t len = in ? 0 : tu_min16(ep_out->len, length - n);
+      if (len) memcpy(ep_out->buf, data + n, len);
+      n += len;
+      ep_out->busy = false;
+      dcd_event_xfer_complete(0, 0x00, len, XFER_RESULT_SUCCESS, false);
+    } else {
+      break;
+    }
+    tud_task();
+  }
+  if (done) *done = n;
+  return !ep0_stalled;
+}
+
+static uint16_t get_descriptor(const uint8_t type, const uint8_t index, const uint16_t itf,
+                               uint8_t *data, const uint16_t length) {
+  const uint8_t recipient = type == HID_DESC_TYPE_REPORT ? TUSB_REQ_RCPT_INTERFACE : TUSB_REQ_RCPT_DEVICE;
+  uint16_t n = 0;
+  require(control(TUSB_DIR_IN_MASK | recipient, TUSB_REQ_GET_DESCRIPTOR, (uint16_t)(type << 8 | index), itf,
+                  data, length, &n));
+  return n;
+}
+
+// one frame of the bus: the host polls the IN endpoints that are due
+static void run_frame(void) {
+  frame++;
+  for (uint8_t num = 1; num < EP_NUM; num++) {
+    mock_endpoint *ep = &eps[num][TUSB_DIR_IN];
+    if (!ep->busy || frame % ep->interval) continue;
+    ep->busy = false;
+    if (ep->instance >= 0 && ep->instance < PORT_NUM) {
+      instance_log *log = &logs[ep->instance];
+      log_packet(log->delivered, &log->delivered_num, ep->buf, ep->len);
+    }
+    dcd_event_xfer_complete(0, tu_edpt_addr(num, TUSB_DIR_IN), ep->len, XFER_RESULT_SUCCESS, false);
+  }
+  tud_task();
+}
+
+//--------------------------------------------------------------------+
+// Application, as in dualjoy.c
+//--------------------------------------------------------------------+
+
+static bool (*instance_ready)(uint8_t instance) = tud_hid_n_ready;
+
+bool report_transmit(const uint8_t instance, const uint8_t report_id, const void *report, const uint16_t len) {
+  transmitting = instance;
+  const bool sent = report_id ? tud_hid_n_report(instance, report_id, report, len)
+                              : xinput_report_send(instance, report);
+  transmitting = -1;
+  if (sent) {
+    // as it goes over the wire, HID reports with their ID in front
+    uint8_t bytes[REPORTS_MAX_LEN + 1];
+    uint16_t n = 0;
+    if (report_id) bytes[n++] = report_id;
+    memcpy(bytes + n, report, len);
+    instance_log *log = &logs[instance];
+    log_packet(log->queued, &log->queued_num, bytes, n + len);
+  }
+  return sent;
+}
+
+bool report_ready(const uint8_t instance) {
+  return instance_ready(instance);
+}
+
+void report_queued(const uint8_t ports) { (void) ports; }
+void report_unchanged(const uint8_t ports) { (void) ports; }
+void report_failed(void) { }
+
+void mouse_direction(const uint8_t pins) { (void) pins; }
+
+bool mouse_take(int8_t *dx, int8_t *dy) {
+  *dx = *dy = 0;
+  return false;
+}
+
+void tud_mount_cb(void) {
+  const uint8_t mode = usb_mode_activate();
+  reports_select(mode);
+  instance_ready = mode == USB_MODE_XINPUT ? xinput_ready : tud_hid_n_ready;
+  reports_resend();
+}
+
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const *report, uint16_t len) {
+  (void) instance; (void) report; (void) len;
+}
+
+void xinput_report_complete_cb(uint8_t port) {
+  (void) port;
+}
+
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                               uint8_t *buffer, uint16_t reqlen) {
+  if (report_type != HID_REPORT_TYPE_INPUT) return 0;
+  return reports_get(instance, report_id, buffer, reqlen);
+}
+
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                           uint8_t const *buffer, uint16_t bufsize) {
+  (void) instance; (void) report_id; (void) report_type; (void) buffer; (void) bufsize;
+}
+
+//--------------------------------------------------------------------+
+// Test
+//--------------------------------------------------------------------+
+
+// pins pressed from a frame on, until the next entry
+static const struct {
+  uint32_t frame;
+  uint16_t pins;   // bit n is pin n, J1 first
+} script[] = {
+  { 3, S(UP) },
+  { 4, S(UP) | S(RIGHT) },
+  { 5, S(RIGHT) | S(PIN_NUM + BTN) },
+  { 9, 0 },
+  { 10, S(PIN_NUM + LEFT) },
+  { 11, S(PIN_NUM + LEFT) | S(DOWN) },
+  { 12, S(DOWN) },
+  { 13, S(DOWN) | S(BTN) },
+  { 30, S(BTN) },
+  { 31, 0 },
+  { 40, S(PIN_NUM + UP) | S(PIN_NUM + BTN) },
+};
+
+static uint32_t script_states(const uint32_t f) {
+  uint16_t pins = 0;
+  for (size_t i = 0; i < sizeof(script) / sizeof(script[0]) && script[i].frame <= f; i++) pins = script[i].pins;
+
+  uint32_t states = 0;
+  for (uint8_t i = 0; i < TOTAL_PIN_NUM; i++) {
+    if (pins & (1 << i)) states |= 1u << input_gpio(i);
+  }
+  return states;
+}
+
+// the endpoints of the selected configuration, with their bInterval
+static uint8_t config_eps[EP_NUM][2];
+// the HID interfaces of the selected configuration, in instance order, and
+// the report IDs in their report descriptors
+static uint8_t hid_itfs[PORT_NUM];
+static uint8_t hid_itf_num;
+static bool report_ids[PORT_NUM][256];
+
+// the mode SET_CONFIGURATION index + 1 has to select: configuration 1 is
+// the mode latched at boot, the others follow in enum order
+static uint8_t configuration_mode(const uint8_t index) {
+  if (index == 0) return boot_mode;
+  return index <= boot_mode ? index - 1 : index;
+}
+
+// reads a configuration descriptor like a host, 9 bytes first, then all
+static void check_configuration(const uint8_t index, const bool selected) {
+  uint8_t desc[DESC_MAX_LEN];
+  require(get_descriptor(TUSB_DESC_CONFIGURATION, index, 0, desc, 9) == 9);
+  const uint16_t total = tu_le16toh(((const tusb_desc_configuration_t *)desc)->wTotalLength);
+  require(total <= sizeof(desc));
+  require(get_descriptor(TUSB_DESC_CONFIGURATION, index, 0, desc, total) == total);
+
+  const tusb_desc_configuration_t *c = (const tusb_desc_configuration_t *)desc;
+  require(c->bDescriptorType == TUSB_DESC_CONFIGURATION && c->bConfigurationValue == index + 1);
+
+  uint8_t interfaces = 0;
+  bool hid = false;
+  if (selected) {
+    memset(config_eps, 0, sizeof(config_eps));
+    hid_itf_num = 0;
+  }
+  for (const uint8_t *d = desc; d < desc + total; d += d[0]) {
+    require(d[0] >= 2 && d + d[0] <= desc + total);
+    if (d[1] == TUSB_DESC_INTERFACE) {
+      const tusb_desc_interface_t *itf = (const tusb_desc_interface_t *)d;
+      hid = itf->bInterfaceClass == TUSB_CLASS_HID;
+      if (itf->bAlternateSetting == 0) interfaces++;
+      if (selected && hid) {
+        require(hid_itf_num < PORT_NUM);
+        hid_itfs[hid_itf_num++] = itf->bInterfaceNumber;
+      }
+    } else if (d[1] == TUSB_DESC_ENDPOINT) {
+      const tusb_desc_endpoint_t *ep = (const tusb_desc_endpoint_t *)d;
+      if (hid) require(ep->bInterval == usb_poll_interval_ms());
+      if (selected) {
+        const uint8_t num = tu_edpt_number(ep->bEndpointAddress);
+        require(num > 0 && num < EP_NUM);
+        config_eps[num][tu_edpt_dir(ep->bEndpointAddress)] = ep->bInterval;
+      }
+    }
+  }
+  require(interfaces == c->bNumInterfaces);
+}
+
+// collects the report IDs of a HID report descriptor from its short items
+static void read_report_ids(const uint8_t instance) {
+  uint8_t desc[DESC_MAX_LEN];
+  const uint16_t len = get_descriptor(HID_DESC_TYPE_REPORT, 0, hid_itfs[instance], desc, sizeof(desc));
+  require(len > 0);
+  memset(report_ids[instance], 0, sizeof(report_ids[instance]));
+  for (uint16_t i = 0; i < len; ) {
+    const uint8_t size = (desc[i] & 3) == 3 ? 4 : desc[i] & 3;
+    require(desc[i] != 0xfe && i + 1 + size <= len); // no long items
+    if ((desc[i] & 0xfc) == 0x84) {
+      require(size == 1);
+      report_ids[instance][desc[i + 1]] = true;
+    }
+    i += 1 + size;
+  }
+}
+
+// selects a configuration like a host, and checks what TinyUSB set up
+static void select_configuration(const uint8_t index) {
+  configuration = index;
+  check_configuration(index, true);
+  require(control(TUSB_REQ_RCPT_DEVICE, TUSB_REQ_SET_CONFIGURATION, index + 1, 0, NULL, 0, NULL));
+  require(tud_mounted() && usb_active_mode() == configuration_mode(index));
+
+  // TinyUSB opened exactly the endpoints of the configuration, with their
+  // interval
+  for (uint8_t num = 1; num < EP_NUM; num++) {
+    for (uint8_t dir = 0; dir < 2; dir++) {
+      const mock_endpoint *ep = &eps[num][dir];
+      require(ep->open == (config_eps[num][dir] != 0));
+      if (ep->open) require(ep->interval == config_eps[num][dir]);
+    }
+  }
+
+  for (uint8_t i = 0; i < hid_itf_num; i++) read_report_ids(i);
+}
+
+static void enumerate(void) {
+  uint8_t desc[DESC_MAX_LEN];
+
+  memset(eps, 0, sizeof(eps));
+  configuration = 0;
+  dcd_event_bus_reset(0, TUSB_SPEED_FULL, false);
+  tud_task();
+
+  require(get_descriptor(TUSB_DESC_DEVICE, 0, 0, desc, 64) == sizeof(tusb_desc_device_t));
+  const tusb_desc_device_t *dev = (const tusb_desc_device_t *)desc;
+  require(dev->bDescriptorType == TUSB_DESC_DEVICE && dev->bMaxPacketSize0 == CFG_TUD_ENDPOINT0_SIZE);
+  require(dev->bNumConfigurations == USB_MODE_NUM);
+  require(((tu_le16toh(dev->idProduct) >> 8) & 0x0f) == boot_mode);
+
+  require(control(TUSB_REQ_RCPT_DEVICE, TUSB_REQ_SET_ADDRESS, 5, 0, NULL, 0, NULL));
+
+  // all configurations, then the first one is selected, like most hosts do
+  for (uint8_t index = 1; index < USB_MODE_NUM; index++) check_configuration(index, false);
+  select_configuration(0);
+}
+
+static void run_script(void) {
+  memset(logs, 0, sizeof(logs));
+  const uint32_t start = frame;
+
+  while (frame - start < SCRIPT_FRAMES) {
+    input_preset(script_states(frame - start));
+    report r[PORT_NUM];
+    for (uint8_t p = 0; p < PORT_NUM; p++) r[p] = input_decode(p);
+    reports_send(r);
+    run_frame();
+  }
+
+  for (uint8_t i = 0; i < PORT_NUM; i++) {
+    if (!reports_ports(i)) continue;
+    const instance_log *log = &logs[i];
+
+    // the first report after the mount is sent in any case
+    require(log->delivered_num > 0);
+    require(log->delivered_num == log->queued_num);
+    for (uint16_t n = 0; n < log->delivered_num; n++) {
+      const packet *q = &log->queued[n], *d = &log->delivered[n];
+      require(q->len == d->len && !memcmp(q->bytes, d->bytes, q->len));
+      if (usb_active_mode() == USB_MODE_XINPUT) continue;
+      require(i < hid_itf_num && report_ids[i][d->bytes[0]]);
+      if (n) require(d->frame - log->delivered[n - 1].frame >= usb_poll_interval_ms());
+    }
+  }
+
+  // the host ends up with the current state, so the final one doesn't
+  // differ from the last report
+  uint16_t queued = 0;
+  for (uint8_t i = 0; i < PORT_NUM; i++) queued += logs[i].queued_num;
+  report r[PORT_NUM];
+  for (uint8_t p = 0; p < PORT_NUM; p++) r[p] = input_decode(p);
+  reports_send(r);
+  for (uint8_t i = 0; i < PORT_NUM; i++) queued -= logs[i].queued_num;
+  require(queued == 0);
+}
+
+int main(void) {
+  static const uint8_t intervals[] = { 1, 5, 8 };
+
+  config_set_defaults(&config);
+  input_setup_pins();
+  input_setup_debounce();
+  tud_init(0);
+
+  for (uint8_t mode = 0; mode < USB_MODE_NUM; mode++) {
+    for (size_t i = 0; i < sizeof(intervals); i++) {
+      config_set_defaults(&config);
+      config.usb_mode = mode;
+      config.poll_interval_ms = intervals[i];
+      usb_latch_config();
+      boot_mode = mode;
+      input_setup_decoders();
+      reports_select(mode);
+
+      // SETs that only apply after a reboot
+      config.usb_mode = (mode + 1) % USB_MODE_NUM;
+      config.poll_interval_ms = intervals[(i + 1) % sizeof(intervals)];
+
+      enumerate();
+      run_script();
+      // the host switches through the other configurations
+      for (uint8_t index = 1; index < USB_MODE_NUM; index++) {
+        select_configuration(index);
+        run_script();
+      }
+      printf("usb_mode %u poll_interval_ms %u ok\n", mode, intervals[i]);
+    }
+  }
+  return 0;
+}
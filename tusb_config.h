@@ -99,7 +99,8 @@
 #define CFG_TUD_VENDOR            0
 
 // HID buffer size Should be sufficient to hold ID (if any) + Data
-#define CFG_TUD_HID_EP_BUFSIZE    16
+// (also used for control transfers, so it has to fit the feature report)
+#define CFG_TUD_HID_EP_BUFSIZE    64
 
 // Add these new definitions for the additional interface
 #define CFG_TUD_HID_EP_COUNT      2    // Number of HID endpoints
@@ -27,6 +27,9 @@
 #include "bsp/board_api.h"
 #include "tusb.h"
 #include "dualjoy.h"
+#include "dualjoy_protocol.h"
+#include "config.h"
+#include "xinput.h"
 
 /* A combination of interfaces must have a unique product id, since PC will save device driver after the first plug.
  * Same VID/PID with different interface e.g MSC (first), then CDC (later) will possibly cause system error on PC.
@@ -41,6 +44,22 @@
 #define USB_VID   0xCAFE
 #define USB_BCD   0x0200
 
+// The mode and polling interval as of the boot. The descriptors only use
+// these, so a SET of usb_mode or poll_interval_ms doesn't change the PID,
+// the order of the configurations or the bInterval under a host that
+// enumerates again before the reboot.
+static uint8_t boot_usb_mode;
+static uint8_t boot_poll_interval_ms = HID_POLL_INTERVAL_MS;
+
+void usb_latch_config(void) {
+  boot_usb_mode = config.usb_mode;
+  boot_poll_interval_ms = config.poll_interval_ms;
+}
+
+uint8_t usb_poll_interval_ms(void) {
+  return boot_poll_interval_ms;
+}
+
 //--------------------------------------------------------------------+
 // Device Descriptors
 //--------------------------------------------------------------------+
@@ -62,7 +81,7 @@ tusb_desc_device_t const desc_device =
     .iProduct           = 0x02,
     .iSerialNumber      = 0x03,
 
-    .bNumConfigurations = 0x01
+    .bNumConfigurations = USB_MODE_NUM
 };
 
 // Invoked when received GET DEVICE DESCRIPTOR
@@ -70,7 +89,13 @@ tusb_desc_device_t const desc_device =
 uint8_t const * tud_descriptor_device_cb(void)
 {
   trace("%s called\n", __func__);
-  return (uint8_t const *) &desc_device;
+  static tusb_desc_device_t desc;
+
+  // every mode has a different set of interfaces, so the host must not mix
+  // up their cached drivers
+  desc = desc_device;
+  desc.idProduct = USB_PID | boot_usb_mode << 8;
+  return (uint8_t const *) &desc;
 }
 
 //--------------------------------------------------------------------+
@@ -120,20 +145,135 @@ uint8_t const * tud_descriptor_device_cb(void)
     HID_INPUT          ( HID_CONSTANT                           ) ,\
   HID_COLLECTION_END \
 
+// Both ports on one gamepad
+// | hat/DPAD port 1 (1 byte) | hat/DPAD port 2 (1 byte) | Button Map (1 byte) |
+#define TUD_HID_REPORT_DESC_COMBINED(...) \
+  HID_USAGE_PAGE ( HID_USAGE_PAGE_DESKTOP     )                 ,\
+  HID_USAGE      ( HID_USAGE_DESKTOP_GAMEPAD  )                 ,\
+  HID_COLLECTION ( HID_COLLECTION_APPLICATION )                 ,\
+    /* Report ID if any */\
+    __VA_ARGS__ \
+    /* 2 x 8 bit DPad/Hat Button Map  */ \
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_DESKTOP                 ) ,\
+    HID_USAGE          ( HID_USAGE_DESKTOP_HAT_SWITCH           ) ,\
+    HID_USAGE          ( HID_USAGE_DESKTOP_HAT_SWITCH           ) ,\
+    HID_LOGICAL_MIN    ( 0                                      ) ,\
+    HID_LOGICAL_MAX    ( 7                                      ) ,\
+    HID_PHYSICAL_MIN   ( 0                                      ) ,\
+    HID_PHYSICAL_MAX_N ( 315, 2                                 ) ,\
+    HID_UNIT_EXPONENT  ( 0x00                                   ) ,\
+    HID_UNIT           ( 0x14                                   ) ,\
+    HID_REPORT_COUNT   ( PORT_NUM                               ) ,\
+    HID_REPORT_SIZE    ( 8                                      ) ,\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE | HID_NULL_STATE ) ,\
+    /* Reset physical/unit globals before button section */ \
+    HID_UNIT_EXPONENT  ( 0x00                                   ) ,\
+    HID_UNIT           ( 0                                      ) ,\
+    HID_PHYSICAL_MIN   ( 0                                      ) ,\
+    HID_PHYSICAL_MAX   ( 0                                      ) ,\
+    /* 8 bit Button Map, a button per port */ \
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_BUTTON                  ) ,\
+    HID_USAGE_MIN      ( 1                                      ) ,\
+    HID_USAGE_MAX      ( PORT_NUM                               ) ,\
+    HID_LOGICAL_MIN    ( 0                                      ) ,\
+    HID_LOGICAL_MAX    ( 1                                      ) ,\
+    HID_REPORT_COUNT   ( PORT_NUM                               ) ,\
+    HID_REPORT_SIZE    ( 1                                      ) ,\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    /* padding */ \
+    HID_REPORT_COUNT   ( 8 - PORT_NUM                           ) ,\
+    HID_REPORT_SIZE    ( 1                                      ) ,\
+    HID_INPUT          ( HID_CONSTANT                           ) ,\
+  HID_COLLECTION_END \
+
+// Vendor defined feature report of the configuration protocol, see
+// dualjoy_protocol.h
+#define TUD_HID_REPORT_DESC_DUALJOY_FEATURE(...) \
+  HID_USAGE_PAGE_N ( HID_USAGE_PAGE_VENDOR, 2   ) ,\
+  HID_USAGE        ( 0x01                       ) ,\
+  HID_COLLECTION   ( HID_COLLECTION_APPLICATION ) ,\
+    /* Report ID if any */\
+    __VA_ARGS__ \
+    HID_USAGE         ( 0x02                                   ) ,\
+    HID_LOGICAL_MIN   ( 0x00                                   ) ,\
+    HID_LOGICAL_MAX_N ( 0xff, 2                                ) ,\
+    HID_REPORT_SIZE   ( 8                                      ) ,\
+    HID_REPORT_COUNT  ( sizeof(dj_feature)                     ) ,\
+    HID_FEATURE       ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+  HID_COLLECTION_END \
+
+// N-key rollover keyboard, a bit for each key
+// | modifiers (1 byte) | key bitmap (KEYBOARD_KEY_NUM / 8 bytes) |
+#define TUD_HID_REPORT_DESC_NKRO_KEYBOARD(...) \
+  HID_USAGE_PAGE ( HID_USAGE_PAGE_DESKTOP     )                 ,\
+  HID_USAGE      ( HID_USAGE_DESKTOP_KEYBOARD )                 ,\
+  HID_COLLECTION ( HID_COLLECTION_APPLICATION )                 ,\
+    /* Report ID if any */\
+    __VA_ARGS__ \
+    /* 8 bit Modifier Keys (Shift, Control, Alt) */ \
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_KEYBOARD                ) ,\
+    HID_USAGE_MIN      ( KEYBOARD_MODIFIER_FIRST                ) ,\
+    HID_USAGE_MAX      ( KEYBOARD_MODIFIER_LAST                 ) ,\
+    HID_LOGICAL_MIN    ( 0                                      ) ,\
+    HID_LOGICAL_MAX    ( 1                                      ) ,\
+    HID_REPORT_COUNT   ( 8                                      ) ,\
+    HID_REPORT_SIZE    ( 1                                      ) ,\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    /* Key bitmap */ \
+    HID_USAGE_MIN      ( 0                                      ) ,\
+    HID_USAGE_MAX      ( KEYBOARD_KEY_NUM - 1                   ) ,\
+    HID_REPORT_COUNT   ( KEYBOARD_KEY_NUM                       ) ,\
+    HID_REPORT_SIZE    ( 1                                      ) ,\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+  HID_COLLECTION_END \
+
 static const uint8_t desc_hid_report1[] = {
   TUD_HID_REPORT_DESC_JOYSTICK(HID_REPORT_ID(JOYSTICK_REPORT_ID)),
+  TUD_HID_REPORT_DESC_DUALJOY_FEATURE(HID_REPORT_ID(DJ_FEATURE_REPORT_ID)),
 };
 
 static const uint8_t desc_hid_report2[] = {
   TUD_HID_REPORT_DESC_JOYSTICK(HID_REPORT_ID(JOYSTICK2_REPORT_ID))
 };
 
+static const uint8_t desc_hid_report_combined[] = {
+  TUD_HID_REPORT_DESC_COMBINED(HID_REPORT_ID(COMBINED_REPORT_ID)),
+  TUD_HID_REPORT_DESC_DUALJOY_FEATURE(HID_REPORT_ID(DJ_FEATURE_REPORT_ID)),
+};
+
+static const uint8_t desc_hid_report_mouse[] = {
+  TUD_HID_REPORT_DESC_MOUSE(HID_REPORT_ID(MOUSE_REPORT_ID)),
+  TUD_HID_REPORT_DESC_DUALJOY_FEATURE(HID_REPORT_ID(DJ_FEATURE_REPORT_ID)),
+};
+
+// only the config protocol, next to the XInput interfaces
+static const uint8_t desc_hid_report_feature[] = {
+  TUD_HID_REPORT_DESC_DUALJOY_FEATURE(HID_REPORT_ID(DJ_FEATURE_REPORT_ID)),
+};
+
+static const uint8_t desc_hid_report_keyboard[] = {
+  TUD_HID_REPORT_DESC_NKRO_KEYBOARD(HID_REPORT_ID(KEYBOARD_REPORT_ID)),
+  TUD_HID_REPORT_DESC_DUALJOY_FEATURE(HID_REPORT_ID(DJ_FEATURE_REPORT_ID)),
+};
+
 // Invoked when received GET HID REPORT DESCRIPTOR
 // Application return pointer to descriptor
 // Descriptor contents must exist long enough for transfer to complete
 uint8_t const * tud_hid_descriptor_report_cb(uint8_t instance)
 {
   trace("%s called\n", __func__);
+  switch (usb_active_mode()) {
+    case USB_MODE_KEYBOARD:
+      return instance == 0 ? desc_hid_report_keyboard : NULL;
+    case USB_MODE_XINPUT:
+      return instance == 0 ? desc_hid_report_feature : NULL;
+    case USB_MODE_MOUSE:
+      return instance == 0 ? desc_hid_report_mouse : NULL;
+    case USB_MODE_COMBINED:
+      return instance == 0 ? desc_hid_report_combined : NULL;
+    default:
+      break;
+  }
   switch (instance) {
     case 0:
       return desc_hid_report1;
@@ -169,6 +309,13 @@ enum {
   STRID_JOYSTICK1,
   STRID_JOYSTICK2,
   STRID_CDC,
+  STRID_KEYBOARD,
+  STRID_CONFIG,
+  STRID_XINPUT1,
+  STRID_XINPUT2,
+  STRID_MOUSE,
+  STRID_COMBINED,
+  STRID_MS_OS = 0xEE, // Microsoft OS 1.0 descriptor
 };
 
 #ifndef LIB_PICO_STDIO_USB
@@ -177,8 +324,21 @@ enum {
 #define  CONFIG_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN * 2 + TUD_CDC_DESC_LEN)
 #endif
 
+#define CONFIG_KEYBOARD_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
+#define CONFIG_COMBINED_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
+#define CONFIG_MOUSE_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
+#define CONFIG_XINPUT_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN + TUD_XINPUT_DESC_LEN * PORT_NUM)
+
 #define EPNUM_HID1   0x81
 #define EPNUM_HID2   0x82
+#define HID_EP_SIZE  16
+
+#define MS_OS_VENDOR_CODE  0x17
+
+#define EPNUM_XINPUT1_IN   0x82
+#define EPNUM_XINPUT1_OUT  0x02
+#define EPNUM_XINPUT2_IN   0x83
+#define EPNUM_XINPUT2_OUT  0x03
 
 #define CDC_EP_CMD (0x83)
 #define CDC_EP_OUT (0x02)
@@ -192,23 +352,128 @@ uint8_t const desc_configuration[] =
   TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
 
   // Interface number, string index, protocol, report descriptor len, EP In address, size & polling interval
-  TUD_HID_DESCRIPTOR(ITF_NUM_HID1, STRID_JOYSTICK1, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report1), EPNUM_HID1, CFG_TUD_HID_EP_BUFSIZE, 5),
-  TUD_HID_DESCRIPTOR(ITF_NUM_HID2, STRID_JOYSTICK2, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report2), EPNUM_HID2, CFG_TUD_HID_EP_BUFSIZE, 5),
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID1, STRID_JOYSTICK1, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report1), EPNUM_HID1, HID_EP_SIZE, HID_POLL_INTERVAL_MS),
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID2, STRID_JOYSTICK2, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report2), EPNUM_HID2, HID_EP_SIZE, HID_POLL_INTERVAL_MS),
 #ifdef LIB_PICO_STDIO_USB
   TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, STRID_CDC, CDC_EP_CMD,CDC_CMD_MAX_SIZE, CDC_EP_OUT, CDC_EP_IN, CDC_IN_OUT_MAX_SIZE),
 #endif
 };
 
+// both ports on one keyboard interface, which also carries the config protocol
+uint8_t const desc_configuration_keyboard[] =
+{
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, CONFIG_KEYBOARD_TOTAL_LEN, 0, 100),
+
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID1, STRID_KEYBOARD, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report_keyboard), EPNUM_HID1, HID_EP_SIZE, HID_POLL_INTERVAL_MS),
+};
+
+// Interface of a wired Xbox 360 controller. The class specific 0x21
+// descriptor is undocumented, its content is copied from real controllers
+// with the endpoint addresses filled in.
+#define TUD_XINPUT_DESC_LEN (9 + 17 + 7 + 7)
+#define TUD_XINPUT_DESCRIPTOR(_itfnum, _stridx, _epin, _epout) \
+  /* Interface */\
+  9, TUSB_DESC_INTERFACE, _itfnum, 0, 2, TUSB_CLASS_VENDOR_SPECIFIC, XINPUT_SUBCLASS, XINPUT_PROTOCOL, _stridx,\
+  /* Class specific */\
+  17, 0x21, 0x00, 0x01, 0x01, 0x25, _epin, 0x14, 0x00, 0x00, 0x00, 0x00, 0x13, _epout, 0x08, 0x00, 0x00,\
+  /* Endpoint In, every frame */\
+  7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(XINPUT_EP_SIZE), 1,\
+  /* Endpoint Out */\
+  7, TUSB_DESC_ENDPOINT, _epout, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(XINPUT_EP_SIZE), 8
+
+// the config protocol on a HID interface, followed by an XInput interface per port
+uint8_t const desc_configuration_xinput[] =
+{
+  TUD_CONFIG_DESCRIPTOR(1, 1 + PORT_NUM, 0, CONFIG_XINPUT_TOTAL_LEN, 0, 100),
+
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID1, STRID_CONFIG, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report_feature), EPNUM_HID1, HID_EP_SIZE, HID_POLL_INTERVAL_MS),
+  TUD_XINPUT_DESCRIPTOR(1, STRID_XINPUT1, EPNUM_XINPUT1_IN, EPNUM_XINPUT1_OUT),
+  TUD_XINPUT_DESCRIPTOR(2, STRID_XINPUT2, EPNUM_XINPUT2_IN, EPNUM_XINPUT2_OUT),
+};
+
+// the mouse and the config protocol on one interface
+uint8_t const desc_configuration_mouse[] =
+{
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, CONFIG_MOUSE_TOTAL_LEN, 0, 100),
+
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID1, STRID_MOUSE, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report_mouse), EPNUM_HID1, HID_EP_SIZE, HID_POLL_INTERVAL_MS),
+};
+
+// both ports and the config protocol on one interface
+uint8_t const desc_configuration_combined[] =
+{
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, CONFIG_COMBINED_TOTAL_LEN, 0, 100),
+
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID1, STRID_COMBINED, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report_combined), EPNUM_HID1, HID_EP_SIZE, HID_POLL_INTERVAL_MS),
+};
+
+static const struct {
+  const uint8_t *desc;
+  uint16_t len;
+} configurations[USB_MODE_NUM] = {
+  [USB_MODE_GAMEPAD] = { desc_configuration, sizeof(desc_configuration) },
+  [USB_MODE_KEYBOARD] = { desc_configuration_keyboard, sizeof(desc_configuration_keyboard) },
+  [USB_MODE_XINPUT] = { desc_configuration_xinput, sizeof(desc_configuration_xinput) },
+  [USB_MODE_MOUSE] = { desc_configuration_mouse, sizeof(desc_configuration_mouse) },
+  [USB_MODE_COMBINED] = { desc_configuration_combined, sizeof(desc_configuration_combined) },
+};
+
+#define CONFIG_DESC_MAX_LEN 128
+_Static_assert(sizeof(desc_configuration) <= CONFIG_DESC_MAX_LEN, "configuration descriptor too long");
+_Static_assert(sizeof(desc_configuration_keyboard) <= CONFIG_DESC_MAX_LEN, "configuration descriptor too long");
+_Static_assert(sizeof(desc_configuration_xinput) <= CONFIG_DESC_MAX_LEN, "configuration descriptor too long");
+_Static_assert(sizeof(desc_configuration_mouse) <= CONFIG_DESC_MAX_LEN, "configuration descriptor too long");
+_Static_assert(sizeof(desc_configuration_combined) <= CONFIG_DESC_MAX_LEN, "configuration descriptor too long");
+
+// Configuration 1 is the mode stored at boot, the others follow in enum
+// order. Hosts that simply take the first configuration get the configured
+// mode, others can switch with SET_CONFIGURATION.
+static uint8_t configuration_mode(const uint8_t index) {
+  if (index == 0) return boot_usb_mode;
+  return index <= boot_usb_mode ? index - 1 : index;
+}
+
+// TinyUSB fetches the descriptor of the configuration it is about to set up
+// right before the mount, so the last requested one is the selected one
+static uint8_t requested_mode = USB_MODE_NUM;
+static uint8_t active_mode = USB_MODE_NUM;
+
+uint8_t usb_mode_activate(void) {
+  active_mode = requested_mode;
+  return active_mode;
+}
+
+uint8_t usb_active_mode(void) {
+  return active_mode < USB_MODE_NUM ? active_mode : boot_usb_mode;
+}
+
 // Invoked when received GET CONFIGURATION DESCRIPTOR
 // Application return pointer to descriptor
 // Descriptor contents must exist long enough for transfer to complete
 uint8_t const * tud_descriptor_configuration_cb(uint8_t index)
 {
   trace("%s called\n", __func__);
-  (void) index; // for multiple configurations
+  static uint8_t desc[CONFIG_DESC_MAX_LEN];
+  if (index >= USB_MODE_NUM) return NULL;
+  const uint8_t mode = configuration_mode(index);
+  const uint16_t len = configurations[mode].len;
+  requested_mode = mode;
+
+  memcpy(desc, configurations[mode].desc, len);
+  ((tusb_desc_configuration_t *)desc)->bConfigurationValue = index + 1;
+
+  // apply the configured polling interval to the HID endpoints
+  bool hid = false;
+  for (uint8_t *d = desc; d < desc + len; d += d[0]) {
+    if (d[1] == TUSB_DESC_INTERFACE) {
+      hid = ((tusb_desc_interface_t *)d)->bInterfaceClass == TUSB_CLASS_HID;
+    } else if (d[1] == TUSB_DESC_ENDPOINT && hid) {
+      ((tusb_desc_endpoint_t *)d)->bInterval = boot_poll_interval_ms;
+    }
+  }
 
   // This example use the same configuration for both high and full speed mode
-  return desc_configuration;
+  return desc;
 }
 
 //--------------------------------------------------------------------+
@@ -225,6 +490,12 @@ char const *string_desc_arr[] =
   "Joystick 1",                  // 4: Joystick 1
   "Joystick 2",                  // 5: Joystick 2
   "CDC",                         // 6: CDC
+  "Keyboard",                    // 7: Keyboard
+  "DualJoy Config",              // 8: Config protocol interface
+  "XInput 1",                    // 9: XInput 1
+  "XInput 2",                    // 10: XInput 2
+  "Mouse",                       // 11: Mouse
+  "Joysticks",                   // 12: Combined gamepad
 };
 
 static uint16_t _desc_str[32 + 1];
@@ -246,6 +517,14 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
       chr_count = board_usb_get_serial(_desc_str + 1, 32);
       break;
 
+    case STRID_MS_OS:
+      // "MSFT100" and the vendor request code of the compat ID descriptor
+      // Windows only ever uses the first configuration
+      if (configuration_mode(0) != USB_MODE_XINPUT) return NULL;
+      for (chr_count = 0; chr_count < 7; chr_count++) _desc_str[1 + chr_count] = "MSFT100"[chr_count];
+      _desc_str[1 + chr_count++] = MS_OS_VENDOR_CODE;
+      break;
+
     default:
       // Note: the 0xEE index string is a Microsoft OS 1.0 Descriptors.
       // https://docs.microsoft.com/en-us/windows-hardware/drivers/usbcon/microsoft-defined-usb-descriptors
@@ -271,3 +550,36 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
 
   return _desc_str;
 }
+
+//--------------------------------------------------------------------+
+// Microsoft OS 1.0 Descriptors
+//--------------------------------------------------------------------+
+
+// binds xusb22 to the XInput interfaces, see
+// https://learn.microsoft.com/en-us/windows-hardware/drivers/usbcon/microsoft-defined-usb-descriptors
+#define MS_OS_COMPAT_ID_INDEX 0x0004
+#define MS_OS_COMPAT_ID_LEN (16 + 24 * PORT_NUM)
+
+#define MS_OS_COMPAT_ID_FUNCTION(_itfnum) \
+  _itfnum, 0x01, \
+  'X', 'U', 'S', 'B', '1', '0', 0, 0, /* compatible ID */ \
+  0, 0, 0, 0, 0, 0, 0, 0,             /* sub compatible ID */ \
+  0, 0, 0, 0, 0, 0
+
+static const uint8_t desc_ms_os_compat_id[MS_OS_COMPAT_ID_LEN] = {
+  U32_TO_U8S_LE(MS_OS_COMPAT_ID_LEN), U16_TO_U8S_LE(0x0100), U16_TO_U8S_LE(MS_OS_COMPAT_ID_INDEX),
+  PORT_NUM, 0, 0, 0, 0, 0, 0, 0,
+  MS_OS_COMPAT_ID_FUNCTION(1),
+  MS_OS_COMPAT_ID_FUNCTION(2),
+};
+
+// Invoked when a control transfer with a vendor request type was received
+bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request)
+{
+  if (stage != CONTROL_STAGE_SETUP) return true;
+  if (configuration_mode(0) != USB_MODE_XINPUT || request->bRequest != MS_OS_VENDOR_CODE ||
+      request->wIndex != MS_OS_COMPAT_ID_INDEX) {
+    return false;
+  }
+  return tud_control_xfer(rhport, request, (void *)(uintptr_t)desc_ms_os_compat_id, sizeof(desc_ms_os_compat_id));
+}
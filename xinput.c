@@ -0,0 +1,139 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+
+#include "dualjoy.h"
+#include "xinput.h"
+
+_Static_assert(sizeof(xinput_report) == 20, "XInput reports are 20 bytes");
+
+typedef struct {
+  uint8_t itf_num;
+  uint8_t ep_in;
+  uint8_t ep_out;
+} xinput_interface;
+
+// the interfaces in the order of the configuration descriptor, one per port
+static xinput_interface interfaces[PORT_NUM];
+static uint8_t interface_count;
+
+CFG_TUSB_MEM_SECTION CFG_TUSB_MEM_ALIGN static xinput_report in_buf[PORT_NUM];
+// rumble and LED commands from the host, ignored
+CFG_TUSB_MEM_SECTION CFG_TUSB_MEM_ALIGN static uint8_t out_buf[PORT_NUM][XINPUT_EP_SIZE];
+
+static void xinput_init(void) {
+  memset(interfaces, 0, sizeof(interfaces));
+  interface_count = 0;
+}
+
+static bool xinput_deinit(void) {
+  return true;
+}
+
+static void xinput_reset(uint8_t rhport) {
+  xinput_init();
+}
+
+static uint16_t xinput_open(uint8_t rhport, tusb_desc_interface_t const *itf_desc, uint16_t max_len) {
+  TU_VERIFY(itf_desc->bInterfaceClass == TUSB_CLASS_VENDOR_SPECIFIC &&
+            itf_desc->bInterfaceSubClass == XINPUT_SUBCLASS &&
+            itf_desc->bInterfaceProtocol == XINPUT_PROTOCOL, 0);
+  TU_VERIFY(interface_count < PORT_NUM, 0);
+
+  // skip the undocumented class specific descriptor. The descriptors are our
+  // own, the length check only keeps a broken TUD_XINPUT_DESCRIPTOR from
+  // hanging tud_task(), fuzz_usb checks that they are all well formed.
+  uint8_t const *p = tu_desc_next(itf_desc);
+  uint16_t len = sizeof(tusb_desc_interface_t);
+  while (len < max_len && tu_desc_type(p) != TUSB_DESC_ENDPOINT) {
+    TU_VERIFY(tu_desc_type(p) != TUSB_DESC_INTERFACE && tu_desc_len(p) != 0, 0);
+    len += tu_desc_len(p);
+    p = tu_desc_next(p);
+  }
+  TU_VERIFY(len + 2 * sizeof(tusb_desc_endpoint_t) <= max_len, 0);
+
+  const uint8_t port = interface_count;
+  xinput_interface *x = &interfaces[port];
+  TU_ASSERT(usbd_open_edpt_pair(rhport, p, 2, TUSB_XFER_INTERRUPT, &x->ep_out, &x->ep_in), 0);
+  x->itf_num = itf_desc->bInterfaceNumber;
+  interface_count++;
+
+  TU_ASSERT(usbd_edpt_xfer(rhport, x->ep_out, out_buf[port], XINPUT_EP_SIZE), 0);
+  return len + 2 * sizeof(tusb_desc_endpoint_t);
+}
+
+static bool xinput_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request) {
+  return false; // no class requests, stall
+}
+
+static bool xinput_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  for (uint8_t port = 0; port < interface_count; port++) {
+    const xinput_interface *x = &interfaces[port];
+    if (ep_addr == x->ep_out) {
+      return usbd_edpt_xfer(rhport, x->ep_out, out_buf[port], XINPUT_EP_SIZE);
+    }
+    if (ep_addr == x->ep_in) {
+      if (result == XFER_RESULT_SUCCESS) xinput_report_complete_cb(port);
+      return true;
+    }
+  }
+  return false;
+}
+
+static const usbd_class_driver_t xinput_driver = {
+#if CFG_TUSB_DEBUG >= 2
+  .name = "XINPUT",
+#endif
+  .init = xinput_init,
+  .deinit = xinput_deinit,
+  .reset = xinput_reset,
+  .open = xinput_open,
+  .control_xfer_cb = xinput_control_xfer_cb,
+  .xfer_cb = xinput_xfer_cb,
+  .sof = NULL,
+};
+
+// Invoked by TinyUSB to get the application class drivers
+usbd_class_driver_t const *usbd_app_driver_get_cb(uint8_t *driver_count) {
+  *driver_count = 1;
+  return &xinput_driver;
+}
+
+bool xinput_ready(const uint8_t port) {
+  return port < interface_count && tud_ready() && !usbd_edpt_busy(BOARD_TUD_RHPORT, interfaces[port].ep_in);
+}
+
+bool xinput_report_send(const uint8_t port, const xinput_report *report) {
+  if (!xinput_ready(port)) return false;
+  const uint8_t ep_in = interfaces[port].ep_in;
+  if (!usbd_edpt_claim(BOARD_TUD_RHPORT, ep_in)) return false;
+  in_buf[port] = *report;
+  if (usbd_edpt_xfer(BOARD_TUD_RHPORT, ep_in, (uint8_t *)&in_buf[port], sizeof(xinput_report))) return true;
+  usbd_edpt_release(BOARD_TUD_RHPORT, ep_in);
+  return false;
+}
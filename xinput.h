@@ -0,0 +1,77 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, Sven Anderson (https://github.com/ansiwen)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef XINPUT_H_
+#define XINPUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// XInput compatible controller interfaces (vendor class 0xFF, subclass 0x5D,
+// protocol 0x01), as wired Xbox 360 controllers have them. Windows binds its
+// xusb22 driver to them through the MS OS 1.0 compat ID "XUSB10", see
+// usb_descriptors.c. Implemented as a TinyUSB application class driver.
+
+#define XINPUT_SUBCLASS 0x5D
+#define XINPUT_PROTOCOL 0x01
+#define XINPUT_EP_SIZE 32
+
+enum xinput_button {
+  XINPUT_DPAD_UP    = 1 << 0,
+  XINPUT_DPAD_DOWN  = 1 << 1,
+  XINPUT_DPAD_LEFT  = 1 << 2,
+  XINPUT_DPAD_RIGHT = 1 << 3,
+  XINPUT_START      = 1 << 4,
+  XINPUT_BACK       = 1 << 5,
+  XINPUT_LS         = 1 << 6,
+  XINPUT_RS         = 1 << 7,
+  XINPUT_LB         = 1 << 8,
+  XINPUT_RB         = 1 << 9,
+  XINPUT_GUIDE      = 1 << 10,
+  XINPUT_A          = 1 << 12,
+  XINPUT_B          = 1 << 13,
+  XINPUT_X          = 1 << 14,
+  XINPUT_Y          = 1 << 15,
+};
+
+typedef struct __attribute__((packed)) {
+  uint8_t type;        // 0x00
+  uint8_t len;         // 20
+  uint16_t buttons;    // enum xinput_button
+  uint8_t lt, rt;
+  int16_t lx, ly, rx, ry;
+  uint8_t reserved[6];
+} xinput_report;
+
+// true if the interface of port is open and its IN endpoint is free
+bool xinput_ready(uint8_t port);
+
+// queues a report on the interface of port, false if it isn't ready
+bool xinput_report_send(uint8_t port, const xinput_report *report);
+
+// invoked when the report of port was picked up by the host, implemented by
+// the application
+void xinput_report_complete_cb(uint8_t port);
+
+#endif /* XINPUT_H_ */